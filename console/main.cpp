@@ -1,4 +1,8 @@
+#include "gdb/GdbServer.hpp"
+
+#include <algorithm>
 #include <csignal>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <format>
@@ -9,9 +13,7 @@
 #include <string>
 #include <system_error>
 #include <thread>
-
 #include <unordered_map>
-#include <unordered_set>
 
 #include <lyra/lyra.hpp>
 #include <readline/history.h>
@@ -25,9 +27,12 @@ import z80_v2;
 import z80_v3;
 #else
 #include "peripherals/Memory.hpp"
+#include "peripherals/Movie.hpp"
 #include "spectrum/Assets.hpp"
+#include "spectrum/Breakpoints.hpp"
 #include "spectrum/Snapshot.hpp"
 #include "spectrum/Spectrum.hpp"
+#include "spectrum/Timeline.hpp"
 #include "z80/v1/Disassembler.hpp"
 #include "z80/v1/Z80.hpp"
 #include "z80/v2/Z80.hpp"
@@ -52,6 +57,7 @@ struct AppBase {
   virtual ~AppBase() = default;
   virtual bool interrupt() = 0;
   virtual int main(const std::vector<std::string> &args) = 0;
+  virtual int serve_gdb(std::uint16_t port, const std::vector<std::string> &exec_on_startup) = 0;
 };
 
 // this is temporary fix for homebrew's clang interacting with older macos' libc++
@@ -72,7 +78,8 @@ template<typename Z80Impl>
 struct App final : AppBase {
   specbolt::Spectrum<Z80Impl> spectrum;
   const specbolt::v1::Disassembler dis;
-  std::unordered_set<std::uint16_t> breakpoints = {};
+  specbolt::Breakpoints breakpoints;
+  specbolt::Timeline<Z80Impl> timeline{spectrum};
   std::unordered_map<std::string, std::function<int(const std::vector<std::string> &)>, hana_string_hash> commands = {};
   std::atomic<bool> interrupted{false};
 
@@ -106,6 +113,30 @@ struct App final : AppBase {
       next(get_number_arg(args));
       return 0;
     };
+    commands["rstep"] = [this](const std::vector<std::string> &args) {
+      reverse([&] { return timeline.step_back(static_cast<std::uint64_t>(get_number_arg(args))); });
+      return 0;
+    };
+    commands["rnext"] = [this](const std::vector<std::string> &args) {
+      const auto num_instructions = get_number_arg(args);
+      reverse([&] {
+        for (int i = 0; i < num_instructions; ++i) {
+          if (!timeline.next_back())
+            return false;
+        }
+        return true;
+      });
+      return 0;
+    };
+    commands["rcontinue"] = [this](const std::vector<std::string> &) {
+      reverse([&] {
+        const auto hit = timeline.continue_back(breakpoints);
+        if (hit)
+          report_hit(*hit);
+        return hit.has_value();
+      });
+      return 0;
+    };
     commands["trace"] = [this](const std::vector<std::string> &args) {
       trace(get_number_arg(args));
       return 0;
@@ -128,11 +159,57 @@ struct App final : AppBase {
     commands["break"] = [this](const std::vector<std::string> &args) {
       if (args.empty()) {
         std::print(std::cout, "Breakpoints:\n");
-        for (auto b: breakpoints)
-          std::print(std::cout, "  0x{:04x}\n", b);
+        for (const auto b: breakpoints.breakpoints()) {
+          if (const auto *condition = breakpoints.condition_for(b))
+            std::print(std::cout, "  0x{:04x} if {}\n", b, condition->expression());
+          else
+            std::print(std::cout, "  0x{:04x}\n", b);
+        }
+      }
+      // Either a list of addresses, or one address followed by "if" and a condition.
+      if (const auto if_pos = std::ranges::find(args, "if"); if_pos != args.end()) {
+        if (if_pos != std::next(args.begin())) {
+          std::print(std::cout, "Syntax: break <address> if <condition>\n");
+          return 0;
+        }
+        std::string expression;
+        for (auto it = std::next(if_pos); it != args.end(); ++it)
+          expression += (expression.empty() ? "" : " ") + *it;
+        try {
+          breakpoints.add_breakpoint(static_cast<std::uint16_t>(parse_num(args[0])), specbolt::Condition(expression));
+        }
+        catch (const std::runtime_error &e) {
+          std::print(std::cout, "{}\n", e.what());
+        }
+        return 0;
       }
       for (const auto &arg: args)
-        breakpoints.insert(static_cast<std::uint16_t>(parse_num(arg)));
+        breakpoints.add_breakpoint(static_cast<std::uint16_t>(parse_num(arg)));
+      return 0;
+    };
+    commands["unbreak"] = [this](const std::vector<std::string> &args) {
+      if (args.empty())
+        breakpoints.clear();
+      for (const auto &arg: args)
+        breakpoints.remove_breakpoint(static_cast<std::uint16_t>(parse_num(arg)));
+      return 0;
+    };
+    commands["watch"] = [this](const std::vector<std::string> &args) {
+      if (args.empty() || args.size() > 2) {
+        std::print(std::cout, "Syntax: watch <address> [<length>]\n");
+        return 0;
+      }
+      const auto length = args.size() > 1 ? static_cast<std::size_t>(parse_num(args[1])) : 1uz;
+      breakpoints.watch_writes(static_cast<std::uint16_t>(parse_num(args[0])), length);
+      return 0;
+    };
+    commands["rwatch"] = [this](const std::vector<std::string> &args) {
+      if (args.empty() || args.size() > 2) {
+        std::print(std::cout, "Syntax: rwatch <address> [<length>]\n");
+        return 0;
+      }
+      const auto length = args.size() > 1 ? static_cast<std::size_t>(parse_num(args[1])) : 1uz;
+      breakpoints.watch_reads(static_cast<std::uint16_t>(parse_num(args[0])), length);
       return 0;
     };
     commands["go"] = [this](const std::vector<std::string> &) {
@@ -141,6 +218,7 @@ struct App final : AppBase {
     };
     commands["reset"] = [this](const std::vector<std::string> &) {
       spectrum.reset();
+      timeline.forget();
       return 0;
     };
     commands["load"] = [this](const std::vector<std::string> &args) {
@@ -149,7 +227,18 @@ struct App final : AppBase {
         return 0;
       }
       std::print(std::cout, "Loading '{}'\n", args[0]);
-      specbolt::Snapshot::load(args[0], spectrum.z80());
+      specbolt::Snapshot::load(args[0], spectrum);
+      timeline.forget();
+      return 0;
+    };
+    commands["movie"] = [this](const std::vector<std::string> &args) {
+      if (args.size() != 1) {
+        std::print(std::cout, "Syntax: movie <movie>\n");
+        return 0;
+      }
+      std::print(std::cout, "Replaying '{}'\n", args[0]);
+      spectrum.play_movie(specbolt::Movie::load(args[0]));
+      timeline.forget();
       return 0;
     };
 
@@ -181,16 +270,31 @@ struct App final : AppBase {
       std::print(std::cout, "Interrupted\n");
       return true;
     }
-    if (breakpoints.contains(spectrum.z80().pc())) {
-      std::print(std::cout, "Hit breakpoint at 0x{:04x}\n", spectrum.z80().pc());
+    if (breakpoints.check(spectrum.z80())) {
+      report_hit(*breakpoints.hit());
       return true;
     }
     return false;
   }
 
+  static void report_hit(const specbolt::Breakpoints::Hit &hit) {
+    switch (hit.kind) {
+      case specbolt::Breakpoints::Hit::Kind::Breakpoint:
+        std::print(std::cout, "Hit breakpoint at 0x{:04x}\n", hit.address);
+        break;
+      case specbolt::Breakpoints::Hit::Kind::Read:
+        std::print(std::cout, "Hit read watchpoint at 0x{:04x}\n", hit.address);
+        break;
+      case specbolt::Breakpoints::Hit::Kind::Write:
+        std::print(std::cout, "Hit write watchpoint at 0x{:04x}\n", hit.address);
+        break;
+    }
+  }
+
   bool _step() {
     try {
       spectrum.run_cycles(1, true);
+      timeline.note_progress();
     }
     catch (const std::exception &e) {
       std::print(std::cout, "Exception: {}\n", e.what());
@@ -204,6 +308,7 @@ struct App final : AppBase {
       const auto prev_pc = spectrum.z80().pc();
       do {
         spectrum.run_cycles(1, true);
+        timeline.note_progress();
       }
       while (spectrum.z80().pc() == prev_pc);
     }
@@ -227,8 +332,32 @@ struct App final : AppBase {
   }
 
   void go() {
-    while (!_step())
-      ;
+    // Run a frame at a time so an interrupt is noticed promptly.
+    try {
+      while (!interrupted.exchange(false)) {
+        const auto hit = spectrum.run_until_break(breakpoints, specbolt::Spectrum<Z80Impl>::cycles_per_frame);
+        timeline.note_progress();
+        if (hit) {
+          report_hit(*breakpoints.hit());
+          return;
+        }
+      }
+      std::print(std::cout, "Interrupted\n");
+    }
+    catch (const std::exception &e) {
+      std::print(std::cout, "Exception: {}\n", e.what());
+    }
+  }
+
+  // Runs `go_back`, which returns false if it ran out of history before getting where it was going.
+  void reverse(const std::function<bool()> &go_back) {
+    try {
+      if (!go_back())
+        std::print(std::cout, "Reached the start of the recorded history\n");
+    }
+    catch (const std::exception &e) {
+      std::print(std::cout, "Exception: {}\n", e.what());
+    }
   }
 
   void trace(const int num_steps) {
@@ -297,6 +426,17 @@ struct App final : AppBase {
     }
     return 0;
   }
+
+  int serve_gdb(const std::uint16_t port, const std::vector<std::string> &exec_on_startup) {
+    for (const auto &cmd: exec_on_startup)
+      execute(cmd);
+    // The timeline turned off bulk block ops so that its positions replay exactly, but gdb has no reverse execution.
+    spectrum.z80().accelerate_block_ops(true);
+    std::print("Waiting for gdb on localhost:{}\n", port);
+    specbolt::GdbConnection connection(port);
+    specbolt::GdbServer<Z80Impl>{spectrum}.serve(connection, interrupted);
+    return 0;
+  }
 };
 
 
@@ -307,12 +447,14 @@ int main(int argc, const char **argv) try {
   bool spec128{};
   bool need_help{};
   int impl{1};
+  int gdb_port{};
   std::filesystem::path snapshot;
 
   const auto cli = lyra::cli() | //
                    lyra::help(need_help) //
                    | lyra::opt(spec128)["--128"]("Use the 128K Spectrum") //
                    | lyra::opt(impl, "impl")["--impl"]("Use the specified implementation.") //
+                   | lyra::opt(gdb_port, "port")["--gdb"]("Serve gdb's remote protocol on localhost:port") //
                    | lyra::opt(exec_on_startup, "cmd")["-x"]["--execute-on-startup"]("Execute command on startup") |
                    lyra::arg(snapshot, "SNAPSHOT")("Snapshot to load");
 
@@ -362,6 +504,8 @@ int main(int argc, const char **argv) try {
   if (!snapshot.empty()) {
     exec_on_startup.insert(exec_on_startup.begin(), "load " + snapshot.string());
   }
+  if (gdb_port > 0)
+    return app->serve_gdb(static_cast<std::uint16_t>(gdb_port), exec_on_startup);
   return app->main(exec_on_startup);
 }
 catch (const std::exception &e) {
@@ -0,0 +1,204 @@
+#include "GdbConnection.hpp"
+
+#include <array>
+#include <cerrno>
+#include <format>
+#include <system_error>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace specbolt {
+
+namespace {
+
+constexpr char Interrupt = '\x03';
+constexpr char Escape = '}';
+
+[[noreturn]] void throw_system_error(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::optional<std::uint8_t> hex_digit(const char c) {
+  if (c >= '0' && c <= '9')
+    return static_cast<std::uint8_t>(c - '0');
+  if (c >= 'a' && c <= 'f')
+    return static_cast<std::uint8_t>(c - 'a' + 10);
+  if (c >= 'A' && c <= 'F')
+    return static_cast<std::uint8_t>(c - 'A' + 10);
+  return std::nullopt;
+}
+
+} // namespace
+
+std::string encode_gdb_packet(const std::string_view payload) {
+  std::string packet = "$";
+  std::uint8_t sum{};
+  const auto append = [&](const char c) {
+    packet += c;
+    sum = static_cast<std::uint8_t>(sum + static_cast<std::uint8_t>(c));
+  };
+  for (const auto c: payload) {
+    if (c == '$' || c == '#' || c == Escape || c == '*') {
+      append(Escape);
+      append(static_cast<char>(c ^ 0x20));
+    }
+    else {
+      append(c);
+    }
+  }
+  return packet + std::format("#{:02x}", sum);
+}
+
+void GdbPacketDecoder::feed(const std::string_view bytes) {
+  for (const auto c: bytes) {
+    switch (state_) {
+      case State::Idle:
+        if (c == '$') {
+          payload_.clear();
+          sum_ = 0;
+          state_ = State::Payload;
+        }
+        else if (c == Interrupt) {
+          interrupt_ = true;
+        }
+        break;
+      case State::Payload:
+      case State::Escape:
+        if (c == '#' && state_ == State::Payload) {
+          state_ = State::Checksum1;
+          break;
+        }
+        sum_ = static_cast<std::uint8_t>(sum_ + static_cast<std::uint8_t>(c));
+        if (state_ == State::Escape) {
+          payload_ += static_cast<char>(c ^ 0x20);
+          state_ = State::Payload;
+        }
+        else if (c == Escape) {
+          state_ = State::Escape;
+        }
+        else {
+          payload_ += c;
+        }
+        break;
+      case State::Checksum1:
+        if (const auto digit = hex_digit(c)) {
+          checksum_ = static_cast<std::uint8_t>(*digit << 4);
+          state_ = State::Checksum2;
+        }
+        else {
+          packets_.push_back({std::move(payload_), false});
+          state_ = State::Idle;
+        }
+        break;
+      case State::Checksum2: {
+        const auto digit = hex_digit(c);
+        packets_.push_back({std::move(payload_), digit && (checksum_ | *digit) == sum_});
+        state_ = State::Idle;
+        break;
+      }
+    }
+  }
+}
+
+std::optional<GdbPacketDecoder::Packet> GdbPacketDecoder::next() {
+  if (packets_.empty())
+    return std::nullopt;
+  auto packet = std::move(packets_.front());
+  packets_.pop_front();
+  return packet;
+}
+
+bool GdbPacketDecoder::take_interrupt() { return std::exchange(interrupt_, false); }
+
+GdbConnection::GdbConnection(const std::uint16_t port) {
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0)
+    throw_system_error("Unable to create the gdb socket");
+  constexpr int enable = 1;
+  ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::bind(listen_fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+    throw_system_error("Unable to bind the gdb socket");
+  if (::listen(listen_fd_, 1) < 0)
+    throw_system_error("Unable to listen on the gdb socket");
+  fd_ = ::accept(listen_fd_, nullptr, nullptr);
+  if (fd_ < 0)
+    throw_system_error("Unable to accept a gdb connection");
+  // Packets are small and each waits for a reply, so don't hold them back.
+  ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+GdbConnection::~GdbConnection() {
+  if (fd_ >= 0)
+    ::close(fd_);
+  if (listen_fd_ >= 0)
+    ::close(listen_fd_);
+}
+
+std::optional<std::string> GdbConnection::receive() {
+  for (;;) {
+    while (auto packet = decoder_.next()) {
+      write_all(packet->valid ? "+" : "-");
+      if (packet->valid)
+        return std::move(packet->payload);
+    }
+    if (!read_more(true))
+      return std::nullopt;
+  }
+}
+
+void GdbConnection::send(const std::string_view payload) {
+  if (connected_)
+    write_all(encode_gdb_packet(payload));
+}
+
+bool GdbConnection::interrupt_requested() {
+  // Losing gdb stops the target too, so that the session can end.
+  return !read_more(false) || decoder_.take_interrupt();
+}
+
+bool GdbConnection::read_more(const bool wait) {
+  if (!connected_)
+    return false;
+  pollfd request{fd_, POLLIN, 0};
+  if (!wait && ::poll(&request, 1, 0) <= 0)
+    return true;
+  std::array<char, 4096> buffer{};
+  const auto bytes = ::recv(fd_, buffer.data(), buffer.size(), 0);
+  if (bytes < 0 && errno != EINTR)
+    throw_system_error("Unable to read from gdb");
+  if (bytes == 0) {
+    connected_ = false;
+    return false;
+  }
+  if (bytes > 0)
+    decoder_.feed(std::string_view(buffer.data(), static_cast<std::size_t>(bytes)));
+  return true;
+}
+
+void GdbConnection::write_all(std::string_view bytes) {
+  while (!bytes.empty()) {
+    const auto written = ::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EPIPE || errno == ECONNRESET) {
+        connected_ = false;
+        return;
+      }
+      throw_system_error("Unable to write to gdb");
+    }
+    bytes.remove_prefix(static_cast<std::size_t>(written));
+  }
+}
+
+} // namespace specbolt
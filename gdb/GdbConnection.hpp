@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace specbolt {
+
+// GDB's remote serial protocol frames each packet as "$payload#xx", where xx is the modulo-256 sum of the payload's
+// bytes in hex, and escapes any '$', '#', '}' or '*' in the payload as '}' followed by the byte xor 0x20.
+[[nodiscard]] std::string encode_gdb_packet(std::string_view payload);
+
+// Splits the bytes gdb sends into packets. Outside a packet, the '+' and '-' acknowledgements are dropped, and a lone
+// ^C, which is how gdb asks a running target to stop, is noted for take_interrupt().
+class GdbPacketDecoder {
+public:
+  struct Packet {
+    std::string payload;
+    // False if the checksum didn't match, in which case gdb should be asked to send it again.
+    bool valid{};
+  };
+
+  void feed(std::string_view bytes);
+  [[nodiscard]] std::optional<Packet> next();
+  [[nodiscard]] bool take_interrupt();
+
+private:
+  enum class State { Idle, Payload, Escape, Checksum1, Checksum2 };
+  State state_{State::Idle};
+  std::string payload_;
+  std::uint8_t sum_{};
+  std::uint8_t checksum_{};
+  std::deque<Packet> packets_;
+  bool interrupt_{};
+};
+
+// A single gdb session over TCP on localhost.
+class GdbConnection {
+public:
+  // Listens on `port` of the loopback interface, and waits for gdb to connect.
+  explicit GdbConnection(std::uint16_t port);
+  ~GdbConnection();
+
+  GdbConnection(const GdbConnection &) = delete;
+  GdbConnection &operator=(const GdbConnection &) = delete;
+
+  // Waits for the next good packet, acknowledging it, and returns its payload; nothing once gdb has gone.
+  [[nodiscard]] std::optional<std::string> receive();
+  void send(std::string_view payload);
+  // Doesn't wait: has gdb asked the target to stop since last time?
+  [[nodiscard]] bool interrupt_requested();
+
+private:
+  int listen_fd_{-1};
+  int fd_{-1};
+  bool connected_{true};
+  GdbPacketDecoder decoder_;
+
+  // Reads whatever has arrived, waiting for something if `wait`. Returns false once gdb has gone.
+  bool read_more(bool wait);
+  void write_all(std::string_view bytes);
+};
+
+} // namespace specbolt
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "GdbConnection.hpp"
+
+#ifndef SPECBOLT_MODULES
+#include "spectrum/Breakpoints.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "z80/common/RegisterFile.hpp"
+#else
+import spectrum;
+import z80_common;
+#endif
+
+namespace specbolt {
+
+// Lets gdb debug the emulated machine over its remote serial protocol. Registers are in the order of gdb's Z80 target:
+// AF, BC, DE, HL, SP, PC, IX, IY, AF', BC', DE', HL' and then I and R together as IR, all 16 bits and little-endian.
+// Software and hardware breakpoints are the same thing here, a bit in the Breakpoints bitmap; watchpoints work too.
+//
+// Continuing runs a frame at a time: through the fast path if nothing is set, otherwise checking the bitmap after each
+// instruction. gdb is only asked whether it wants the machine stopped every PollFrames frames, so a running machine
+// loses next to no time to the debugger.
+template<typename Z80Impl>
+class GdbServer {
+public:
+  explicit GdbServer(Spectrum<Z80Impl> &spectrum) : spectrum_(spectrum) {}
+
+  // Serves one session, returning when gdb detaches, kills the target or goes away. A running machine also stops when
+  // `interrupted` is set, e.g. by ^C in the console; a ^C from before gdb resumed it doesn't count.
+  void serve(GdbConnection &connection, std::atomic<bool> &interrupted) {
+    while (const auto packet = connection.receive()) {
+      const std::string_view request = *packet;
+      if (request == "k")
+        return;
+      if (request.starts_with('c') || request.starts_with('s')) {
+        interrupted = false;
+        connection.send(
+            resume(request, [&] { return connection.interrupt_requested() || interrupted.exchange(false); }));
+        continue;
+      }
+      connection.send(reply(request));
+      if (request.starts_with('D'))
+        return;
+    }
+  }
+
+  // Replies to everything but running the machine. An empty reply tells gdb a request isn't supported.
+  std::string reply(std::string_view request) {
+    if (request == "?")
+      return "S05";
+    if (request.starts_with("qSupported"))
+      return "PacketSize=4000";
+    if (request == "qAttached")
+      return "1";
+    if (request.starts_with('H') || request == "D")
+      return "OK";
+
+    const auto command = request.front();
+    request.remove_prefix(1);
+    switch (command) {
+      case 'g': {
+        std::string result;
+        for (auto index = 0uz; index < NumRegisters; ++index)
+          result += hex16(read_register(index));
+        return result;
+      }
+      case 'G':
+        for (auto index = 0uz; index < NumRegisters; ++index) {
+          const auto value = take_hex16(request);
+          if (!value)
+            return "E01";
+          write_register(index, *value);
+        }
+        return "OK";
+      case 'p': {
+        const auto index = take_hex(request);
+        return index && *index < NumRegisters ? hex16(read_register(*index)) : "E01";
+      }
+      case 'P': {
+        const auto index = take_hex(request);
+        if (!index || *index >= NumRegisters || !take(request, '='))
+          return "E01";
+        const auto value = take_hex16(request);
+        if (!value)
+          return "E01";
+        write_register(*index, *value);
+        return "OK";
+      }
+      case 'm': {
+        const auto address = take_hex(request);
+        const auto length = take(request, ',') ? take_hex(request) : std::nullopt;
+        if (!address || !length)
+          return "E01";
+        std::string result;
+        for (auto offset = 0u; offset < *length && offset < 0x10000; ++offset)
+          result += std::format("{:02x}", spectrum_.memory().peek(static_cast<std::uint16_t>(*address + offset)));
+        return result;
+      }
+      case 'M': {
+        const auto address = take_hex(request);
+        const auto length = take(request, ',') ? take_hex(request) : std::nullopt;
+        if (!address || !length || !take(request, ':') || request.size() != *length * 2)
+          return "E01";
+        for (auto offset = 0u; offset < *length; ++offset) {
+          auto digits = request.substr(offset * 2, 2);
+          const auto byte = take_hex(digits);
+          if (!byte)
+            return "E01";
+          spectrum_.memory().raw_write(static_cast<std::uint16_t>(*address + offset), static_cast<std::uint8_t>(*byte));
+        }
+        return "OK";
+      }
+      case 'Z':
+      case 'z': {
+        const auto type = take_hex(request);
+        const auto address = take(request, ',') ? take_hex(request) : std::nullopt;
+        const auto kind = take(request, ',') ? take_hex(request) : std::nullopt;
+        if (!type || !address || !kind || *type > 4)
+          return "E01";
+        set_breakpoint(*type, static_cast<std::uint16_t>(*address), *kind, command == 'Z');
+        return "OK";
+      }
+      default: return "";
+    }
+  }
+
+  // Continues or steps, optionally from a new address, and returns the reply saying why the machine stopped. A running
+  // machine is stopped if `stop_requested()`, which is asked every PollFrames frames.
+  template<typename StopRequested>
+  std::string resume(std::string_view request, StopRequested &&stop_requested) {
+    const bool step = request.front() == 's';
+    request.remove_prefix(1);
+    if (const auto address = take_hex(request))
+      spectrum_.z80().regs().pc(static_cast<std::uint16_t>(*address));
+    if (step)
+      return spectrum_.run_until_break(breakpoints_, 1) ? stop_reply(*breakpoints_.hit()) : "S05";
+    for (auto frame = 0uz;; ++frame) {
+      if (frame % PollFrames == 0 && stop_requested())
+        return "S02";
+      if (!breakpoints_.has_breakpoints() && !breakpoints_.has_watchpoints())
+        spectrum_.run_frame();
+      else if (spectrum_.run_until_break(breakpoints_, Spectrum<Z80Impl>::cycles_per_frame))
+        return stop_reply(*breakpoints_.hit());
+    }
+  }
+
+private:
+  static constexpr std::size_t NumRegisters = 13;
+  static constexpr std::size_t PollFrames = 10;
+
+  Spectrum<Z80Impl> &spectrum_;
+  Breakpoints breakpoints_;
+
+  static std::string stop_reply(const Breakpoints::Hit &hit) {
+    switch (hit.kind) {
+      case Breakpoints::Hit::Kind::Read: return std::format("T05rwatch:{:04x};", hit.address);
+      case Breakpoints::Hit::Kind::Write: return std::format("T05watch:{:04x};", hit.address);
+      case Breakpoints::Hit::Kind::Breakpoint: break;
+    }
+    return "S05";
+  }
+
+  // Types 0 and 1 are software and hardware breakpoints, 2 to 4 are write, read and access watchpoints of `kind` bytes.
+  void set_breakpoint(const std::uint32_t type, const std::uint16_t address, const std::size_t kind, const bool set) {
+    if (type <= 1) {
+      if (set)
+        breakpoints_.add_breakpoint(address);
+      else
+        breakpoints_.remove_breakpoint(address);
+      return;
+    }
+    if (type == 2 || type == 4) {
+      if (set)
+        breakpoints_.watch_writes(address, kind);
+      else
+        breakpoints_.unwatch_writes(address, kind);
+    }
+    if (type == 3 || type == 4) {
+      if (set)
+        breakpoints_.watch_reads(address, kind);
+      else
+        breakpoints_.unwatch_reads(address, kind);
+    }
+  }
+
+  [[nodiscard]] std::uint16_t read_register(const std::size_t index) {
+    const auto &regs = spectrum_.z80().regs();
+    switch (index) {
+      case 0: return regs.get(RegisterFile::R16::AF);
+      case 1: return regs.get(RegisterFile::R16::BC);
+      case 2: return regs.get(RegisterFile::R16::DE);
+      case 3: return regs.get(RegisterFile::R16::HL);
+      case 4: return regs.sp();
+      case 5: return regs.pc();
+      case 6: return regs.ix();
+      case 7: return regs.iy();
+      case 8: return regs.get(RegisterFile::R16::AF_);
+      case 9: return regs.get(RegisterFile::R16::BC_);
+      case 10: return regs.get(RegisterFile::R16::DE_);
+      case 11: return regs.get(RegisterFile::R16::HL_);
+      default: return static_cast<std::uint16_t>(regs.i() << 8 | regs.r());
+    }
+  }
+
+  void write_register(const std::size_t index, const std::uint16_t value) {
+    auto &regs = spectrum_.z80().regs();
+    switch (index) {
+      case 0: regs.set(RegisterFile::R16::AF, value); break;
+      case 1: regs.set(RegisterFile::R16::BC, value); break;
+      case 2: regs.set(RegisterFile::R16::DE, value); break;
+      case 3: regs.set(RegisterFile::R16::HL, value); break;
+      case 4: regs.sp(value); break;
+      case 5: regs.pc(value); break;
+      case 6: regs.set(RegisterFile::R16::IX, value); break;
+      case 7: regs.set(RegisterFile::R16::IY, value); break;
+      case 8: regs.set(RegisterFile::R16::AF_, value); break;
+      case 9: regs.set(RegisterFile::R16::BC_, value); break;
+      case 10: regs.set(RegisterFile::R16::DE_, value); break;
+      case 11: regs.set(RegisterFile::R16::HL_, value); break;
+      default:
+        regs.i(static_cast<std::uint8_t>(value >> 8));
+        regs.r(static_cast<std::uint8_t>(value));
+        break;
+    }
+  }
+
+  static std::string hex16(const std::uint16_t value) { return std::format("{:02x}{:02x}", value & 0xff, value >> 8); }
+
+  // The parsers consume what they accept from the front of `text`.
+  static std::optional<std::uint32_t> take_hex(std::string_view &text) {
+    std::uint32_t value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+    if (error != std::errc{})
+      return std::nullopt;
+    text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+    return value;
+  }
+  static std::optional<std::uint16_t> take_hex16(std::string_view &text) {
+    if (text.size() < 4)
+      return std::nullopt;
+    auto low = text.substr(0, 2);
+    auto high = text.substr(2, 2);
+    const auto low_byte = take_hex(low);
+    const auto high_byte = take_hex(high);
+    if (!low_byte || !high_byte || !low.empty() || !high.empty())
+      return std::nullopt;
+    text.remove_prefix(4);
+    return static_cast<std::uint16_t>(*high_byte << 8 | *low_byte);
+  }
+  static bool take(std::string_view &text, const char c) {
+    if (!text.starts_with(c))
+      return false;
+    text.remove_prefix(1);
+    return true;
+  }
+};
+
+} // namespace specbolt
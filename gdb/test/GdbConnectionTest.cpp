@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "GdbConnection.hpp"
+
+namespace specbolt {
+
+TEST_CASE("gdb packet tests", "[GdbConnection]") {
+  SECTION("encodes with a checksum") {
+    CHECK(encode_gdb_packet("") == "$#00");
+    CHECK(encode_gdb_packet("OK") == "$OK#9a");
+    CHECK(encode_gdb_packet("S05") == "$S05#b8");
+  }
+
+  SECTION("escapes the framing characters") { CHECK(encode_gdb_packet("a}b") == "$a}]b#6c"); }
+
+  SECTION("decodes what it encodes") {
+    GdbPacketDecoder decoder;
+    decoder.feed(encode_gdb_packet("m4000,10") + encode_gdb_packet("x#$}*"));
+    const auto first = decoder.next();
+    REQUIRE(first);
+    CHECK(first->valid);
+    CHECK(first->payload == "m4000,10");
+    const auto second = decoder.next();
+    REQUIRE(second);
+    CHECK(second->valid);
+    CHECK(second->payload == "x#$}*");
+    CHECK(!decoder.next());
+  }
+
+  SECTION("decodes packets split across reads") {
+    GdbPacketDecoder decoder;
+    decoder.feed("+$O");
+    CHECK(!decoder.next());
+    decoder.feed("K#9");
+    CHECK(!decoder.next());
+    decoder.feed("a");
+    const auto packet = decoder.next();
+    REQUIRE(packet);
+    CHECK(packet->valid);
+    CHECK(packet->payload == "OK");
+  }
+
+  SECTION("flags bad checksums") {
+    GdbPacketDecoder decoder;
+    decoder.feed("$OK#00");
+    const auto packet = decoder.next();
+    REQUIRE(packet);
+    CHECK(!packet->valid);
+  }
+
+  SECTION("notes interrupts between packets") {
+    GdbPacketDecoder decoder;
+    CHECK(!decoder.take_interrupt());
+    decoder.feed("-\x03");
+    CHECK(!decoder.next());
+    CHECK(decoder.take_interrupt());
+    CHECK(!decoder.take_interrupt());
+  }
+}
+
+} // namespace specbolt
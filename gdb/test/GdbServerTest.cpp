@@ -0,0 +1,156 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "GdbServer.hpp"
+
+#ifdef SPECBOLT_MODULES
+import spectrum;
+import z80_common;
+import z80_v2;
+#else
+#include "spectrum/Assets.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "z80/common/RegisterFile.hpp"
+#include "z80/v2/Z80.hpp"
+#endif
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+namespace specbolt {
+
+namespace {
+
+struct Machine {
+  Spectrum<v2::Z80> spectrum{Variant::Spectrum48, get_asset_dir() / "48.rom", 44'100};
+  GdbServer<v2::Z80> server{spectrum};
+
+  // Puts `code` at 0x8000 and starts there; interrupts are still off from the reset.
+  void load(const std::initializer_list<std::uint8_t> code) {
+    auto address = std::uint16_t{0x8000};
+    for (const auto byte: code)
+      spectrum.memory().raw_write(address++, byte);
+    spectrum.z80().regs().pc(0x8000);
+  }
+  auto &regs() { return spectrum.z80().regs(); }
+};
+
+constexpr auto never = [] { return false; };
+constexpr auto at_once = [] { return true; };
+
+} // namespace
+
+TEST_CASE("gdb server tests", "[GdbServer]") {
+  Machine machine;
+  auto &server = machine.server;
+  auto &regs = machine.regs();
+
+  SECTION("reads the registers in gdb's order") {
+    regs.set(RegisterFile::R16::AF, 0x1234);
+    regs.set(RegisterFile::R16::BC, 0x2345);
+    regs.set(RegisterFile::R16::DE, 0x3456);
+    regs.set(RegisterFile::R16::HL, 0x4567);
+    regs.sp(0x5678);
+    regs.pc(0x6789);
+    regs.set(RegisterFile::R16::IX, 0x789a);
+    regs.set(RegisterFile::R16::IY, 0x89ab);
+    regs.set(RegisterFile::R16::AF_, 0x9abc);
+    regs.set(RegisterFile::R16::BC_, 0xabcd);
+    regs.set(RegisterFile::R16::DE_, 0xbcde);
+    regs.set(RegisterFile::R16::HL_, 0xcdef);
+    regs.i(0xde);
+    regs.r(0x7f);
+    CHECK(server.reply("g") == "3412452356346745785689679a78ab89bc9acdabdebcefcd7fde");
+    CHECK(server.reply("p5") == "8967");
+    CHECK(server.reply("pc") == "7fde");
+    CHECK(server.reply("pd") == "E01");
+    CHECK(server.reply("p") == "E01");
+  }
+
+  SECTION("writes the registers in gdb's order") {
+    CHECK(server.reply("G3412452356346745785689679a78ab89bc9acdabdebcefcd7fde") == "OK");
+    CHECK(regs.get(RegisterFile::R16::AF) == 0x1234);
+    CHECK(regs.get(RegisterFile::R16::BC) == 0x2345);
+    CHECK(regs.get(RegisterFile::R16::DE) == 0x3456);
+    CHECK(regs.get(RegisterFile::R16::HL) == 0x4567);
+    CHECK(regs.sp() == 0x5678);
+    CHECK(regs.pc() == 0x6789);
+    CHECK(regs.ix() == 0x789a);
+    CHECK(regs.iy() == 0x89ab);
+    CHECK(regs.get(RegisterFile::R16::AF_) == 0x9abc);
+    CHECK(regs.get(RegisterFile::R16::BC_) == 0xabcd);
+    CHECK(regs.get(RegisterFile::R16::DE_) == 0xbcde);
+    CHECK(regs.get(RegisterFile::R16::HL_) == 0xcdef);
+    CHECK(regs.i() == 0xde);
+    CHECK(regs.r() == 0x7f);
+
+    CHECK(server.reply("P5=0080") == "OK");
+    CHECK(regs.pc() == 0x8000);
+    CHECK(server.reply("P3=cdab") == "OK");
+    CHECK(regs.get(RegisterFile::R16::HL) == 0xabcd);
+  }
+
+  SECTION("rejects malformed register writes") {
+    regs.pc(0x1234);
+    CHECK(server.reply("G3412") == "E01");
+    CHECK(server.reply("P5") == "E01");
+    CHECK(server.reply("P5=00") == "E01");
+    CHECK(server.reply("P5=zz80") == "E01");
+    CHECK(server.reply("Pd=0080") == "E01");
+    CHECK(regs.pc() == 0x1234);
+  }
+
+  SECTION("reads and writes memory") {
+    CHECK(server.reply("M8000,3:01ab7f") == "OK");
+    CHECK(machine.spectrum.memory().peek(0x8000) == 0x01);
+    CHECK(machine.spectrum.memory().peek(0x8001) == 0xab);
+    CHECK(machine.spectrum.memory().peek(0x8002) == 0x7f);
+    CHECK(server.reply("m8000,3") == "01ab7f");
+    CHECK(server.reply("m8001,1") == "ab");
+    CHECK(server.reply("m0,2") == "f3af");
+    CHECK(server.reply("M8000,2:01") == "E01");
+    CHECK(server.reply("M8000,1:zz") == "E01");
+    CHECK(server.reply("m8000") == "E01");
+  }
+
+  SECTION("steps one instruction") {
+    machine.load({0x00, 0x00, 0x00});
+    CHECK(server.resume("s", never) == "S05");
+    CHECK(regs.pc() == 0x8001);
+    CHECK(server.resume("s8000", never) == "S05");
+    CHECK(regs.pc() == 0x8001);
+  }
+
+  SECTION("continues to a breakpoint") {
+    // loop: nop; nop; jr loop
+    machine.load({0x00, 0x00, 0x18, 0xfc});
+    for (const auto *type: {"0", "1"}) {
+      INFO(type);
+      regs.pc(0x8000);
+      CHECK(server.reply(std::string("Z") + type + ",8001,1") == "OK");
+      CHECK(server.resume("c", never) == "S05");
+      CHECK(regs.pc() == 0x8001);
+      CHECK(server.reply(std::string("z") + type + ",8001,1") == "OK");
+      CHECK(server.resume("c", at_once) == "S02");
+    }
+  }
+
+  SECTION("continues to a watchpoint") {
+    // loop: ld a,(0x9000); ld (0x9001),a; jr loop
+    machine.load({0x3a, 0x00, 0x90, 0x32, 0x01, 0x90, 0x18, 0xf8});
+    CHECK(server.reply("Z2,9001,1") == "OK");
+    CHECK(server.resume("c", never) == "T05watch:9001;");
+    CHECK(server.reply("z2,9001,1") == "OK");
+    CHECK(server.reply("Z3,9000,1") == "OK");
+    CHECK(server.resume("c", never) == "T05rwatch:9000;");
+    CHECK(server.reply("z3,9000,1") == "OK");
+    CHECK(server.reply("Z4,9001,1") == "OK");
+    CHECK(server.resume("c", never) == "T05watch:9001;");
+    CHECK(server.reply("z4,9001,1") == "OK");
+    CHECK(server.resume("c", at_once) == "S02");
+    CHECK(server.reply("Z5,9000,1") == "E01");
+    CHECK(server.reply("Z0,8000") == "E01");
+  }
+}
+
+} // namespace specbolt
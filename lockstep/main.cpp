@@ -0,0 +1,159 @@
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <print>
+#include <stdexcept>
+
+#include <lyra/lyra.hpp>
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+import spectrum;
+import z80_v1;
+import z80_v2;
+import z80_v3;
+#else
+#include "peripherals/Movie.hpp"
+#include "spectrum/Assets.hpp"
+#include "spectrum/Snapshot.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "z80/v1/Disassembler.hpp"
+#include "z80/v1/Z80.hpp"
+#include "z80/v2/Z80.hpp"
+#include "z80/v3/Z80.hpp"
+#endif
+
+namespace specbolt {
+
+namespace {
+
+// Runs two Spectrums with different Z80 implementations side by side, comparing a state hash every frame. On a
+// mismatch it replays both from the start up to the offending frame, then single-steps to find the first instruction
+// where they disagree.
+struct Lockstep {
+  std::filesystem::path rom;
+  std::filesystem::path snapshot;
+  std::filesystem::path movie;
+  int impl_a{2};
+  int impl_b{3};
+  std::size_t frames{500};
+  bool spec128{};
+
+  template<typename Z80Impl>
+  std::unique_ptr<Spectrum<Z80Impl>> make() const {
+    auto spectrum =
+        std::make_unique<Spectrum<Z80Impl>>(spec128 ? Variant::Spectrum128 : Variant::Spectrum48, rom, 44'100);
+    // Only the machine state is compared, never the picture.
+    spectrum->rendering(false);
+    if (!snapshot.empty())
+      Snapshot::load(snapshot, *spectrum);
+    if (!movie.empty())
+      spectrum->play_movie(Movie::load(movie));
+    return spectrum;
+  }
+
+  static bool same(auto &lhs, auto &rhs) {
+    return lhs.z80().cycle_count() == rhs.z80().cycle_count() && lhs.state_hash() == rhs.state_hash();
+  }
+
+  template<typename ImplA, typename ImplB>
+  int run() const {
+    std::optional<std::size_t> diverged_frame;
+    {
+      const auto a = make<ImplA>();
+      const auto b = make<ImplB>();
+      for (auto frame = 0uz; frame < frames; ++frame) {
+        a->run_frame();
+        b->run_frame();
+        if (!same(*a, *b)) {
+          diverged_frame = frame;
+          break;
+        }
+      }
+    }
+    if (!diverged_frame) {
+      std::println("Implementations {} and {} agree over {} frames", impl_a, impl_b, frames);
+      return 0;
+    }
+
+    std::println("Implementations {} and {} diverge in frame {}", impl_a, impl_b, *diverged_frame);
+    const auto a = make<ImplA>();
+    const auto b = make<ImplB>();
+    for (auto frame = 0uz; frame < *diverged_frame; ++frame) {
+      a->run_frame();
+      b->run_frame();
+    }
+    // Prime the hashers so each step only rehashes what it touched.
+    static_cast<void>(same(*a, *b));
+    const v1::Disassembler dis_a{a->memory()};
+    const v1::Disassembler dis_b{b->memory()};
+    // Every instruction takes at least one cycle, so a frame can't contain more instructions than this.
+    for (auto instruction = 0uz; instruction < Spectrum<ImplA>::cycles_per_frame; ++instruction) {
+      const auto pc_a = a->z80().pc();
+      const auto pc_b = b->z80().pc();
+      a->run_cycles(1, true);
+      b->run_cycles(1, true);
+      if (same(*a, *b))
+        continue;
+      std::println("First difference after instruction {} of the frame", instruction);
+      std::println("  {}: {} (cycle {})", impl_a, dis_a.disassemble(pc_a).to_string(), a->z80().cycle_count());
+      a->z80().regs().dump(std::cout, "    ");
+      std::println("  {}: {} (cycle {})", impl_b, dis_b.disassemble(pc_b).to_string(), b->z80().cycle_count());
+      b->z80().regs().dump(std::cout, "    ");
+      return 1;
+    }
+    std::println("Unable to reproduce the divergence when single-stepping");
+    return 1;
+  }
+};
+
+template<typename Func>
+int with_impl(const int impl, Func &&func) {
+  switch (impl) {
+    case 1: return func.template operator()<v1::Z80>();
+    case 2: return func.template operator()<v2::Z80>();
+    case 3: return func.template operator()<v3::Z80>();
+    default: break;
+  }
+  throw std::runtime_error(std::format("Bad implementation {}", impl));
+}
+
+} // namespace
+
+} // namespace specbolt
+
+int main(const int argc, const char *argv[]) try {
+  specbolt::Lockstep lockstep;
+  bool need_help{};
+  const auto cli = lyra::cli() //
+                   | lyra::help(need_help) //
+                   | lyra::opt(lockstep.spec128)["--128"]("Use the 128K Spectrum") //
+                   | lyra::opt(lockstep.rom, "ROM")["--rom"]("Where to find the ROM") //
+                   | lyra::opt(lockstep.impl_a, "impl")["--impl-a"]("First implementation to compare") //
+                   | lyra::opt(lockstep.impl_b, "impl")["--impl-b"]("Second implementation to compare") //
+                   | lyra::opt(lockstep.frames, "NUM")["--frames"]("Number of frames to run") //
+                   | lyra::opt(lockstep.movie, "MOVIE")["--movie"]("Replay keyboard input from MOVIE") //
+                   | lyra::arg(lockstep.snapshot, "SNAPSHOT")("Snapshot to load");
+  if (const auto parse_result = cli.parse({argc, argv}); !parse_result) {
+    std::println(std::cerr, "Error in command line: {}", parse_result.message());
+    return 1;
+  }
+  if (need_help) {
+    std::cout << cli << '\n';
+    return 0;
+  }
+  if (lockstep.rom.empty())
+    lockstep.rom = specbolt::get_asset_dir() / (lockstep.spec128 ? "128.rom" : "48.rom");
+
+  return specbolt::with_impl(lockstep.impl_a, [&]<typename ImplA>() {
+    return specbolt::with_impl(
+        lockstep.impl_b, [&]<typename ImplB>() { return lockstep.run<ImplA, ImplB>(); });
+  });
+}
+catch (const std::exception &e) {
+  std::cerr << "Exception: " << e.what() << "\n";
+  return 1;
+}
@@ -11,15 +11,20 @@ Audio::Audio(const std::size_t sample_rate, const std::size_t clock_rate) {
   blip_synth_.volume(1.0);
   blip_synth_.treble_eq(-37.0);
   blip_synth_.output(&blip_buffer_);
+  ay_.output(blip_buffer_);
 }
 
 void Audio::set_output(const std::size_t total_cycles, const bool beeper, const bool tape) {
+  if (muted_)
+    return;
   beeper_on_ = beeper;
   tape_output_ = tape;
   update(total_cycles);
 }
 
 void Audio::set_tape_input(const std::size_t total_cycles, const bool tape_in) {
+  if (muted_)
+    return;
   tape_input_ = tape_in;
   update(total_cycles);
 }
@@ -37,6 +42,7 @@ void Audio::update(const std::size_t total_cycles) {
 }
 
 std::vector<std::int16_t> Audio::end_frame(const std::size_t total_cycles) {
+  ay_.end_frame(total_cycles - last_frame_);
   blip_buffer_.end_frame(total_cycles - last_frame_);
   last_frame_ = total_cycles;
   std::vector<std::int16_t> result;
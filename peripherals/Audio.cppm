@@ -7,6 +7,7 @@ module;
 
 export module peripherals:Audio;
 
+import :Ay;
 import :Blip_Buffer;
 
 #include "peripherals/Audio.hpp"
@@ -0,0 +1,198 @@
+#ifndef SPECBOLT_MODULES
+#include "peripherals/Ay.hpp"
+
+#include <algorithm>
+#endif
+
+namespace specbolt {
+
+namespace {
+
+// Unused bits read back as zero.
+constexpr std::array<std::uint8_t, Ay::NumRegisters> RegisterMasks{
+    0xff, 0x0f, 0xff, 0x0f, 0xff, 0x0f, 0x1f, 0xff, 0x1f, 0x1f, 0x1f, 0xff, 0xff, 0x0f, 0xff, 0xff};
+
+constexpr std::size_t MixerRegister = 7;
+constexpr std::size_t VolumeRegister = 8;
+constexpr std::size_t EnvelopeShapeRegister = 13;
+
+// The chip's logarithmic volume steps, measured from real hardware and scaled so all three channels at full volume
+// stay well clear of clipping alongside the beeper.
+constexpr std::array<int, 16> Volumes = [] {
+  constexpr std::array<int, 16> measured{
+      0, 836, 1212, 1773, 2619, 3875, 5397, 8823, 10392, 16706, 23339, 29292, 36969, 46421, 55195, 65535};
+  constexpr int max_per_channel = 24 * 256;
+  std::array<int, 16> scaled{};
+  for (auto i = 0uz; i < measured.size(); ++i)
+    scaled[i] = measured[i] * max_per_channel / 65535;
+  return scaled;
+}();
+
+} // namespace
+
+Ay::Ay() {
+  synth_.volume(1.0);
+  synth_.treble_eq(-37.0);
+}
+
+std::int64_t Ay::tone_period(const std::size_t channel) const {
+  const auto period = registers_[channel * 2] | registers_[channel * 2 + 1] << 8;
+  return std::max(period, 1) * CyclesPerToneUnit;
+}
+
+std::int64_t Ay::noise_period() const { return std::max<std::int64_t>(registers_[6], 1) * CyclesPerNoiseUnit; }
+
+std::int64_t Ay::envelope_period() const {
+  const auto period = registers_[11] | registers_[12] << 8;
+  return std::max(period, 1) * CyclesPerEnvelopeUnit;
+}
+
+// A tone only matters while its channel is mixed in and not silent; otherwise its phase is unobservable and it needn't
+// be clocked at all.
+bool Ay::tone_active(const std::size_t channel) const {
+  return !(registers_[MixerRegister] & (1 << channel)) && registers_[VolumeRegister + channel];
+}
+
+bool Ay::noise_active() const {
+  for (auto channel = 0uz; channel < 3; ++channel) {
+    if (!(registers_[MixerRegister] & (8 << channel)) && registers_[VolumeRegister + channel])
+      return true;
+  }
+  return false;
+}
+
+std::uint8_t Ay::volume(const std::size_t channel) const {
+  const auto reg = registers_[VolumeRegister + channel];
+  return static_cast<std::uint8_t>(reg & 0x10 ? envelope_step_ ^ envelope_attack_ : reg & 0x0f);
+}
+
+void Ay::write(const std::size_t time, const std::uint8_t value) {
+  run_to(time);
+  const auto reg = selected_;
+  const auto old_period = reg < 6    ? tone_period(reg / 2)
+                          : reg == 6 ? noise_period()
+                                     : envelope_period();
+  registers_[reg] = static_cast<std::uint8_t>(value & RegisterMasks[reg]);
+  // A shortened period takes effect at once if the counter has already passed it, like the chip's own comparison.
+  if (reg < 6) {
+    auto &next = tone_next_[reg / 2];
+    next = std::max(next - old_period + tone_period(reg / 2), now_);
+  }
+  else if (reg == 6) {
+    noise_next_ = std::max(noise_next_ - old_period + noise_period(), now_);
+  }
+  else if (reg == 11 || reg == 12) {
+    envelope_next_ = std::max(envelope_next_ - old_period + envelope_period(), now_);
+  }
+  else if (reg == EnvelopeShapeRegister) {
+    envelope_attack_ = value & 0x04 ? 0x0f : 0x00;
+    envelope_step_ = 0x0f;
+    envelope_holding_ = false;
+    envelope_next_ = now_ + envelope_period();
+  }
+  wake_idle_counters();
+  update_level(now_);
+}
+
+void Ay::write_silently(const std::uint8_t value) {
+  registers_[selected_] = static_cast<std::uint8_t>(value & RegisterMasks[selected_]);
+}
+
+void Ay::restore(const Checkpoint &checkpoint) {
+  registers_ = checkpoint.registers;
+  selected_ = checkpoint.selected;
+  wake_idle_counters();
+  update_level(now_);
+}
+
+void Ay::run_to(const std::size_t time) {
+  const auto until = static_cast<std::int64_t>(time);
+  for (;;) {
+    auto next = until + 1;
+    for (auto channel = 0uz; channel < 3; ++channel) {
+      if (tone_active(channel))
+        next = std::min(next, tone_next_[channel]);
+    }
+    if (noise_active())
+      next = std::min(next, noise_next_);
+    if (!envelope_holding_)
+      next = std::min(next, envelope_next_);
+    if (next > until)
+      break;
+
+    for (auto channel = 0uz; channel < 3; ++channel) {
+      if (tone_active(channel) && tone_next_[channel] == next) {
+        tone_high_[channel] = !tone_high_[channel];
+        tone_next_[channel] += tone_period(channel);
+      }
+    }
+    if (noise_active() && noise_next_ == next) {
+      noise_high_ = noise_rng_ & 1;
+      noise_rng_ = noise_rng_ >> 1 | ((noise_rng_ ^ noise_rng_ >> 3) & 1) << 16;
+      noise_next_ += noise_period();
+    }
+    if (!envelope_holding_ && envelope_next_ == next) {
+      step_envelope();
+      envelope_next_ += envelope_period();
+    }
+    update_level(next);
+  }
+  now_ = std::max(now_, until);
+}
+
+void Ay::end_frame(const std::size_t time) {
+  run_to(time);
+  const auto frame_length = static_cast<std::int64_t>(time);
+  now_ -= frame_length;
+  for (auto &next: tone_next_)
+    next -= frame_length;
+  noise_next_ -= frame_length;
+  envelope_next_ -= frame_length;
+}
+
+void Ay::step_envelope() {
+  if (envelope_step_ > 0) {
+    --envelope_step_;
+    return;
+  }
+  const auto shape = registers_[EnvelopeShapeRegister];
+  // Without "continue" every shape ends silent, whatever its attack.
+  if (!(shape & 0x08)) {
+    envelope_attack_ = 0;
+    envelope_holding_ = true;
+    return;
+  }
+  if (shape & 0x02)
+    envelope_attack_ ^= 0x0f;
+  if (shape & 0x01)
+    envelope_holding_ = true;
+  else
+    envelope_step_ = 0x0f;
+}
+
+// Counters that weren't being clocked pick up from now, as their phase was never observable.
+void Ay::wake_idle_counters() {
+  for (auto channel = 0uz; channel < 3; ++channel) {
+    if (tone_active(channel) && tone_next_[channel] < now_)
+      tone_next_[channel] = now_ + tone_period(channel);
+  }
+  if (noise_active() && noise_next_ < now_)
+    noise_next_ = now_ + noise_period();
+}
+
+void Ay::update_level(const std::int64_t time) {
+  const auto noise_mix = registers_[MixerRegister] >> 3;
+  int level{};
+  for (auto channel = 0uz; channel < 3; ++channel) {
+    const bool tone = tone_high_[channel] || registers_[MixerRegister] & (1 << channel);
+    const bool noise = noise_high_ || noise_mix & (1 << channel);
+    if (tone && noise)
+      level += Volumes[volume(channel)];
+  }
+  if (level == level_)
+    return;
+  synth_.update(static_cast<blip_time_t>(time), level);
+  level_ = level;
+}
+
+} // namespace specbolt
@@ -0,0 +1,13 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+export module peripherals:Ay;
+
+import :Blip_Buffer;
+
+#include "peripherals/Ay.hpp"
+
+#include "Ay.cpp"
@@ -14,7 +14,11 @@ Memory::Memory(const int num_pages) {
   if (num_pages < 4) {
     throw std::runtime_error("Memory must have at least 4 pages");
   }
+  if (num_pages > 64) {
+    throw std::runtime_error("Memory must have at most 64 pages");
+  }
   address_space_.resize(static_cast<std::size_t>(num_pages) * page_size);
+  block_write_stamps_.resize(address_space_.size() / WriteBlockSize);
 }
 
 std::uint8_t Memory::read(const std::uint16_t address) const {
@@ -37,6 +41,9 @@ void Memory::write(const std::uint16_t address, const std::uint8_t byte) {
 
   if (rom_[address / page_size])
     return;
+  // One unsigned compare covers both ends of the range, and never matches when nothing is watched.
+  if (offset_for(address) - watch_start_ < watch_size_) [[unlikely]]
+    watcher_->before_write();
   raw_write(address, byte);
 }
 
@@ -46,21 +53,108 @@ void Memory::write16(const std::uint16_t address, const std::uint16_t word) {
 }
 
 void Memory::raw_write(const std::uint16_t address, const std::uint8_t byte) {
-  address_space_[offset_for(address)] = byte;
+  const auto offset = offset_for(address);
+  note_write(offset);
+  address_space_[offset] = byte;
 }
 
 void Memory::raw_write(const std::uint8_t page, const std::uint16_t offset, const std::uint8_t byte) {
+  note_write(page * page_size + offset);
   address_space_[page * page_size + offset] = byte;
 }
 
 void Memory::raw_write_checked(const std::uint8_t page, const std::uint16_t offset, const std::uint8_t byte) {
   address_space_.at(page * page_size + offset) = byte;
+  note_write(page * page_size + offset);
 }
 
 std::uint8_t Memory::raw_read(const std::uint8_t page, const std::uint16_t offset) const {
   return address_space_[page * page_size + offset];
 }
 
+void Memory::copy_block(
+    const std::uint16_t from, const std::uint16_t to, const std::size_t count, const bool increment) {
+  if (count == 0)
+    return;
+  // Work on the lowest address of each range, whichever way the copy runs.
+  const auto source = increment ? offset_for(from) : offset_for(from) - (count - 1);
+  const auto dest = increment ? offset_for(to) : offset_for(to) - (count - 1);
+  auto *const data = address_space_.data();
+  // Only a destination the copy runs into changes the result from a plain memmove.
+  if (increment ? dest > source && dest < source + count : dest < source && dest + count > source) {
+    for (auto index = 0uz; index < count; ++index) {
+      const auto offset = increment ? index : count - 1 - index;
+      data[dest + offset] = data[source + offset];
+    }
+  }
+  else {
+    std::memmove(data + dest, data + source, count);
+  }
+  for (auto block = dest / WriteBlockSize; block * WriteBlockSize < dest + count; ++block)
+    note_write(block * WriteBlockSize);
+}
+
+void Memory::watch_writes(
+    WriteWatcher *const watcher, const std::uint8_t page, const std::uint16_t offset, const std::size_t size) {
+  watcher_ = watcher;
+  watch_start_ = page * page_size + offset;
+  watch_size_ = watcher ? size : 0;
+}
+
+bool Memory::watched(const std::uint16_t address, const std::size_t count, const bool increment) const {
+  const auto first = increment ? offset_for(address) : offset_for(address) - (count - 1);
+  return count && watch_size_ && first < watch_start_ + watch_size_ && watch_start_ < first + count;
+}
+
+std::size_t Memory::find_byte(
+    const std::uint16_t address, const std::size_t count, const bool increment, const std::uint8_t byte) const {
+  const auto physical = offset_for(address);
+  if (increment) {
+    const auto *const start = address_space_.data() + physical;
+    const auto *const found = static_cast<const std::uint8_t *>(std::memchr(start, byte, count));
+    return found ? static_cast<std::size_t>(found - start) : count;
+  }
+  for (auto index = 0uz; index < count; ++index) {
+    if (address_space_[physical - index] == byte)
+      return index;
+  }
+  return count;
+}
+
+void Memory::checkpoint(Checkpoint &into) const {
+  if (into.contents.size() != address_space_.size()) {
+    into.contents = address_space_;
+  }
+  else {
+    for (auto block = 0uz; block < block_write_stamps_.size(); ++block) {
+      if (block_write_stamps_[block] > into.write_stamp)
+        std::memcpy(into.contents.data() + block * WriteBlockSize, address_space_.data() + block * WriteBlockSize,
+            WriteBlockSize);
+    }
+  }
+  into.page_table = page_table_;
+  into.rom = rom_;
+  into.write_stamp = write_stamp_;
+}
+
+void Memory::restore(const Checkpoint &checkpoint) {
+  if (checkpoint.contents.size() != address_space_.size())
+    throw std::runtime_error("Checkpoint is for a different size of memory");
+  for (auto block = 0uz; block < block_write_stamps_.size(); ++block) {
+    if (block_write_stamps_[block] > checkpoint.write_stamp) {
+      std::memcpy(address_space_.data() + block * WriteBlockSize, checkpoint.contents.data() + block * WriteBlockSize,
+          WriteBlockSize);
+      note_write(block * WriteBlockSize);
+    }
+  }
+  page_table_ = checkpoint.page_table;
+  rom_ = checkpoint.rom;
+}
+
+std::span<const std::uint8_t> Memory::page_data(const std::uint8_t page) const {
+  return std::span(address_space_).subspan(page * page_size, page_size);
+}
+
 void Memory::load(const std::filesystem::path &filename, const std::uint8_t page, const std::uint16_t offset,
     const std::uint16_t size) {
   std::ifstream load_stream(filename, std::ios::binary);
@@ -77,6 +171,8 @@ void Memory::load(const std::filesystem::path &filename, const std::uint8_t page
   }
 
   load_stream.read(reinterpret_cast<char *>(address_space_.data() + raw_offset), size);
+  for (auto block = raw_offset / WriteBlockSize; block * WriteBlockSize < raw_offset + size; ++block)
+    note_write(block * WriteBlockSize);
 
   if (!load_stream) {
     throw std::runtime_error(std::format("Unable to read file '{}' (read size = {} bytes)", filename.c_str(), size));
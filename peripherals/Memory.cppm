@@ -6,6 +6,7 @@ module;
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
@@ -0,0 +1,104 @@
+#ifndef SPECBOLT_MODULES
+#include "peripherals/Movie.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#endif
+
+namespace specbolt {
+
+namespace {
+
+// File layout: the magic, a version byte, then one record per event until the end of the file. Each record is a pair
+// of LEB128 varints: the cycle delta from the previous event shifted left one with the pressed flag in bit 0, then the
+// key code. Typical sessions have events thousands of cycles apart, so most records fit in four or five bytes.
+constexpr std::array<std::uint8_t, 4> Magic{'S', 'B', 'M', 'V'};
+constexpr std::uint8_t Version = 1;
+
+void write_varint(std::vector<std::uint8_t> &output, std::uint64_t value) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t read_varint(std::span<const std::uint8_t> &input) {
+  std::uint64_t value{};
+  for (auto shift = 0u; shift < 64; shift += 7) {
+    if (input.empty())
+      throw std::runtime_error("Truncated movie file");
+    const auto byte = input.front();
+    input = input.subspan(1);
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  throw std::runtime_error("Bad varint in movie file");
+}
+
+} // namespace
+
+void Movie::record(const std::size_t cycle, const std::int32_t key_code, const bool pressed) {
+  if (!events_.empty() && cycle < events_.back().cycle)
+    throw std::runtime_error(std::format("Movie event at {} recorded before {}", cycle, events_.back().cycle));
+  events_.push_back(Event{cycle, key_code, pressed});
+}
+
+std::vector<std::uint8_t> Movie::serialise() const {
+  std::vector<std::uint8_t> output(Magic.begin(), Magic.end());
+  output.push_back(Version);
+  std::size_t last_cycle{};
+  for (const auto &[cycle, key_code, pressed]: events_) {
+    write_varint(output, static_cast<std::uint64_t>(cycle - last_cycle) << 1 | (pressed ? 1 : 0));
+    write_varint(output, static_cast<std::uint32_t>(key_code));
+    last_cycle = cycle;
+  }
+  return output;
+}
+
+Movie Movie::deserialise(std::span<const std::uint8_t> data) {
+  if (data.size() < Magic.size() + 1 || !std::ranges::equal(data.first(Magic.size()), Magic))
+    throw std::runtime_error("Not a movie file");
+  if (const auto version = data[Magic.size()]; version != Version)
+    throw std::runtime_error(std::format("Unsupported movie version {}", version));
+  data = data.subspan(Magic.size() + 1);
+
+  Movie movie;
+  std::size_t cycle{};
+  while (!data.empty()) {
+    const auto delta_and_pressed = read_varint(data);
+    const auto key_code = read_varint(data);
+    cycle += static_cast<std::size_t>(delta_and_pressed >> 1);
+    movie.events_.push_back(
+        Event{cycle, static_cast<std::int32_t>(static_cast<std::uint32_t>(key_code)), (delta_and_pressed & 1) != 0});
+  }
+  return movie;
+}
+
+void Movie::save(const std::filesystem::path &path) const {
+  std::ofstream save_stream(path, std::ios::binary);
+  if (!save_stream) {
+    throw std::runtime_error(std::format("Failed to open file '{}': {}", path.string(), std::strerror(errno)));
+  }
+  const auto data = serialise();
+  save_stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!save_stream)
+    throw std::runtime_error(std::format("Unable to write file '{}'", path.string()));
+}
+
+Movie Movie::load(const std::filesystem::path &path) {
+  std::ifstream load_stream(path, std::ios::binary);
+  if (!load_stream) {
+    throw std::runtime_error(std::format("Failed to open file '{}': {}", path.string(), std::strerror(errno)));
+  }
+  const std::vector<std::uint8_t> data(std::istreambuf_iterator<char>(load_stream), {});
+  return deserialise(data);
+}
+
+} // namespace specbolt
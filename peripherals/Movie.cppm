@@ -0,0 +1,19 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+export module peripherals:Movie;
+
+#include "peripherals/Movie.hpp"
+
+#include "Movie.cpp"
@@ -35,13 +35,37 @@ constexpr std::array palette_swapped = [] {
   return result;
 }();
 
-constexpr auto PalTotalLines = 312zu;
+constexpr auto PalTotalLines = static_cast<std::size_t>(Video::LinesPerFrame);
 constexpr auto VSyncLines = PalTotalLines - Video::VisibleHeight;
 // constexpr auto HSyncPixels = 64;
 constexpr auto FramesPerFlash = 16;
 
 constexpr auto AttributeDataOffset = 0x1800;
 
+// The beam draws 8 pixels every 4 T-states. A line's screen area starts as the line does, so its left border is drawn
+// at the end of the line before.
+constexpr auto CyclesPerCell = 4uz;
+constexpr auto LeftBorderCells = static_cast<std::size_t>(Video::XBorder / 8);
+constexpr auto LeftBorderCycles = LeftBorderCells * CyclesPerCell;
+
+// The 48K raises its interrupt as a line starts, 64 lines (14336 T-states) before the first screen line does.
+constexpr auto FirstScreenLine = VSyncLines + Video::YBorder;
+constexpr auto InterruptLine = FirstScreenLine - 64;
+
+// While the ULA fetches the 128 T-states of a screen line's pixels and attributes it stalls contended accesses, by an
+// amount that repeats every 8 T-states. The pattern starts one T-state before the line's first fetch, 14335 T-states
+// after the interrupt.
+constexpr auto ContentionTable = [] {
+  std::array<std::uint8_t, Video::CyclesPerFrame> table{};
+  constexpr std::array<std::uint8_t, 8> pattern{6, 5, 4, 3, 2, 1, 0, 0};
+  constexpr auto ContendedCyclesPerLine = 128uz;
+  for (auto line = FirstScreenLine; line < FirstScreenLine + Video::ScreenHeight; ++line) {
+    for (auto offset = 0uz; offset < ContendedCyclesPerLine; ++offset)
+      table[line * Video::CyclesPerScanLine - 1 + offset] = pattern[offset % pattern.size()];
+  }
+  return table;
+}();
+
 } // namespace
 
 Video::Video(const Memory &memory) : memory_(memory) {}
@@ -58,9 +82,11 @@ bool Video::poll(const std::size_t num_cycles) {
 }
 
 bool Video::next_scan_line() {
-  render_line(current_line_);
+  if (!beam_racing_ && rendering_)
+    render_line(current_line_);
+  const auto line = current_line_;
   current_line_ = (current_line_ + 1) % PalTotalLines;
-  if (current_line_ == 0) {
+  if (line == InterruptLine) {
     if (++flash_counter_ == FramesPerFlash) {
       flash_counter_ = 0;
       flash_on_ = !flash_on_;
@@ -77,13 +103,17 @@ void Video::blit_to(const std::span<std::uint32_t> screen, const bool swap_rgb)
   for (auto y = 0uz; y < VisibleHeight; ++y) {
     const auto &[border, columns] = lines_[y];
     auto line_span = screen.subspan(y * VisibleWidth, VisibleWidth);
+    const auto fill_border = [&](const std::size_t first_cell, const std::size_t end_cell) {
+      for (auto cell = first_cell; cell < end_cell; ++cell)
+        std::ranges::fill(line_span.subspan(cell * 8, 8), pal[border[cell]]);
+    };
     if (y < YBorder || y >= YBorder + ScreenHeight) {
-      std::ranges::fill(line_span, pal[border]);
+      fill_border(0, CellCount);
       continue;
     }
     // Left and right borders.
-    std::ranges::fill(line_span.subspan(0, XBorder), pal[border]);
-    std::ranges::fill(line_span.subspan(XBorder + ScreenWidth, XBorder), pal[border]);
+    fill_border(0, LeftBorderCells);
+    fill_border(LeftBorderCells + ColumnCount, CellCount);
 
     const auto display_span = line_span.subspan(XBorder, ScreenWidth);
     for (std::size_t x = 0; x < ColumnCount; ++x) {
@@ -102,11 +132,60 @@ void Video::blit_to(const std::span<std::uint32_t> screen, const bool swap_rgb)
   }
 }
 
+std::span<const std::uint8_t> Video::contention_table() { return ContentionTable; }
+
+void Video::beam_racing(const bool enable, const std::size_t cycle) {
+  beam_racing_ = enable;
+  // Start from the next whole line; the one in progress was snapshotted when it began.
+  beam_line_ = cycle / CyclesPerScanLine + 1;
+  beam_cell_ = 0;
+}
+
+void Video::catch_up(const std::size_t cycle) {
+  if (!beam_racing_)
+    return;
+  // Times are shifted by the left border so the cells drawn at the end of the previous line don't go negative.
+  const auto beam_until = cycle + LeftBorderCycles;
+  if (!rendering_) {
+    // Jump straight to the first cell not yet due.
+    const auto cell = (beam_until % CyclesPerScanLine + CyclesPerCell - 1) / CyclesPerCell;
+    const auto next_line = cell < CellCount ? beam_until / CyclesPerScanLine : beam_until / CyclesPerScanLine + 1;
+    const auto next_cell = cell < CellCount ? cell : 0;
+    if (next_line > beam_line_ || (next_line == beam_line_ && next_cell > beam_cell_)) {
+      beam_line_ = next_line;
+      beam_cell_ = next_cell;
+    }
+    return;
+  }
+  while (beam_line_ * CyclesPerScanLine + beam_cell_ * CyclesPerCell < beam_until) {
+    render_cell(beam_line_ % PalTotalLines, beam_cell_);
+    if (++beam_cell_ == CellCount) {
+      beam_cell_ = 0;
+      ++beam_line_;
+    }
+  }
+}
+
+void Video::render_cell(const std::size_t display_line, const std::size_t cell) {
+  if (display_line < VSyncLines)
+    return;
+  auto &[border, columns] = lines_[display_line - VSyncLines];
+  border[cell] = border_;
+  const auto y = display_line - YBorder - VSyncLines;
+  const auto x = cell - LeftBorderCells;
+  if (y >= ScreenHeight || x >= ColumnCount) // unsigned, so also catches the top and left borders
+    return;
+  const auto screen_offset = ((y >> 6 & 0x03) << 11) + ((y >> 3 & 0x07) << 5) + ((y & 0x07) << 8);
+  columns[x].pixel = memory_.raw_read(page_, static_cast<std::uint16_t>(screen_offset + x));
+  columns[x].attribute =
+      memory_.raw_read(page_, static_cast<std::uint16_t>(AttributeDataOffset + y / 8 * ColumnCount + x));
+}
+
 void Video::render_line(const std::size_t display_line) {
   if (display_line < VSyncLines)
     return;
   auto &[border, columns] = lines_[display_line - VSyncLines];
-  border = border_;
+  border.fill(border_);
   const auto y = display_line - YBorder - VSyncLines;
   if (y >= ScreenHeight) // also handles y < 0 as unsigned above does that...
     return;
@@ -3,6 +3,7 @@
 #ifndef SPECBOLT_MODULES
 #include <cstdint>
 #include <span>
+#include "peripherals/Ay.hpp"
 #include "peripherals/Blip_Buffer.hpp"
 #endif
 
@@ -15,8 +16,28 @@ public:
   void set_output(std::size_t total_cycles, bool beeper, bool tape);
   void set_tape_input(std::size_t total_cycles, bool tape_in);
 
+  // The 128K's AY sound chip, behind ports 0xfffd (register select and read) and 0xbffd (write).
+  void select_sound_chip_register(const std::uint8_t reg) { ay_.select(reg); }
+  [[nodiscard]] std::uint8_t sound_chip_register() const { return ay_.selected(); }
+  [[nodiscard]] std::uint8_t read_sound_chip() const { return ay_.read(); }
+  void write_sound_chip(const std::size_t total_cycles, const std::uint8_t value) {
+    if (muted_)
+      ay_.write_silently(value);
+    else
+      ay_.write(total_cycles - last_frame_, value);
+  }
+
   std::vector<std::int16_t> end_frame(std::size_t total_cycles);
 
+  // Only what the program can read back, which is the sound chip's registers. What's been played stays played.
+  using Checkpoint = Ay::Checkpoint;
+  [[nodiscard]] Checkpoint checkpoint() const { return ay_.checkpoint(); }
+  void restore(const Checkpoint &checkpoint) { ay_.restore(checkpoint); }
+
+  // While muted nothing is played, and nothing changes but what a program can read back. So after running ahead muted
+  // from a checkpoint, restoring it leaves the sound just as it was.
+  void mute(const bool muted) { muted_ = muted; }
+
 private:
   void update(std::size_t total_cycles);
   std::int16_t current_output_{};
@@ -24,8 +45,10 @@ private:
   bool beeper_on_{};
   bool tape_output_{};
   bool tape_input_{};
+  bool muted_{};
   Blip_Buffer blip_buffer_;
   Blip_Synth<blip_good_quality, 65535> blip_synth_;
+  Ay ay_;
 };
 
 } // namespace specbolt
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include <array>
+#include <cstdint>
+#include "peripherals/Blip_Buffer.hpp"
+#endif
+
+namespace specbolt {
+
+// The AY-3-8912 sound chip of the 128K machines. Rather than clocking the chip every cycle, each tone, noise and
+// envelope counter records when it next changes, and run_to() jumps from one such event to the next, handing only the
+// changes in output level to a Blip_Synth. Times are in CPU cycles relative to the start of the current Blip_Buffer
+// frame.
+SPECBOLT_EXPORT class Ay {
+public:
+  static constexpr std::size_t NumRegisters = 16;
+
+  Ay();
+
+  void output(Blip_Buffer &buffer) { synth_.output(&buffer); }
+
+  void select(const std::uint8_t reg) { selected_ = reg & 0x0f; }
+  [[nodiscard]] std::uint8_t selected() const { return selected_; }
+  [[nodiscard]] std::uint8_t read() const { return registers_[selected_]; }
+  void write(std::size_t time, std::uint8_t value);
+  // Changes the selected register as a program would see it, but without the sound noticing.
+  void write_silently(std::uint8_t value);
+
+  void run_to(std::size_t time);
+  void end_frame(std::size_t time);
+
+  // The registers, which are all a program can see of the chip. Restoring them leaves the counters running, so the
+  // sound carries on from where it is rather than jumping back.
+  struct Checkpoint {
+    std::array<std::uint8_t, NumRegisters> registers{};
+    std::uint8_t selected{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const { return {registers_, selected_}; }
+  void restore(const Checkpoint &checkpoint);
+
+  [[nodiscard]] int level() const { return level_; }
+
+private:
+  // The chip runs at half the CPU clock. Tones toggle every 8 chip cycles per unit of period; noise and the envelope
+  // advance every 16.
+  static constexpr std::int64_t CyclesPerToneUnit = 16;
+  static constexpr std::int64_t CyclesPerNoiseUnit = 32;
+  static constexpr std::int64_t CyclesPerEnvelopeUnit = 32;
+
+  std::array<std::uint8_t, NumRegisters> registers_{};
+  std::uint8_t selected_{};
+
+  std::int64_t now_{};
+  std::array<std::int64_t, 3> tone_next_{};
+  std::array<bool, 3> tone_high_{};
+  std::int64_t noise_next_{};
+  std::uint32_t noise_rng_{1};
+  bool noise_high_{};
+  std::int64_t envelope_next_{};
+  std::uint8_t envelope_step_{};
+  std::uint8_t envelope_attack_{};
+  bool envelope_holding_{true};
+
+  int level_{};
+  Blip_Synth<blip_good_quality, 65535> synth_;
+
+  [[nodiscard]] std::int64_t tone_period(std::size_t channel) const;
+  [[nodiscard]] std::int64_t noise_period() const;
+  [[nodiscard]] std::int64_t envelope_period() const;
+  [[nodiscard]] bool tone_active(std::size_t channel) const;
+  [[nodiscard]] bool noise_active() const;
+  [[nodiscard]] std::uint8_t volume(std::size_t channel) const;
+
+  void step_envelope();
+  void wake_idle_counters();
+  void update_level(std::int64_t time);
+};
+
+} // namespace specbolt
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <functional>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <vector>
 #endif
@@ -26,6 +27,14 @@ public:
     virtual void on_memory_write(std::uint16_t address) = 0;
   };
 
+  // Told just before a write lands in one range of physical memory, e.g. so video can catch up with the beam first.
+  // Unlike a Listener, it costs nothing for writes elsewhere.
+  class WriteWatcher {
+  public:
+    virtual ~WriteWatcher() = default;
+    virtual void before_write() = 0;
+  };
+
   explicit Memory(int num_pages);
   [[nodiscard]] std::uint8_t read(std::uint16_t address) const;
   [[nodiscard]] std::uint16_t read16(std::uint16_t address) const;
@@ -43,11 +52,65 @@ public:
   [[nodiscard]] const auto &page_table() const { return page_table_; }
   void set_rom_flags(const std::array<bool, 4> rom) { rom_ = rom; }
   [[nodiscard]] const auto &rom_flags() const { return rom_; }
+  // Physical pages the ULA shares with the CPU, one bit per page; accesses to them may be delayed.
+  void set_contended_pages(const std::uint64_t pages) { contended_pages_ = pages; }
+  [[nodiscard]] bool contended(const std::uint16_t address) const {
+    return contended_pages_ >> page_table_[address / page_size] & 1;
+  }
+
+  // Each physical page is flagged when written so consumers (e.g. state hashing) need only revisit changed pages.
+  [[nodiscard]] std::uint64_t dirty_pages() const { return dirty_pages_; }
+  void clear_dirty_pages() { dirty_pages_ = 0; }
+  [[nodiscard]] std::size_t num_pages() const { return address_space_.size() / page_size; }
+  [[nodiscard]] std::span<const std::uint8_t> page_data(std::uint8_t page) const;
+
+  // Every write stamps its WriteBlockSize-byte block of physical memory with a new, increasing value. Caches of decoded
+  // code remember write_stamp() when they decode, and are stale once their block's stamp is newer. Keying on physical
+  // addresses means page-table changes are caught by comparing physical_address() too.
+  static constexpr auto WriteBlockSize = 0x100uz;
+  [[nodiscard]] std::uint64_t write_stamp() const { return write_stamp_; }
+  [[nodiscard]] std::uint64_t block_write_stamp(const std::size_t physical_address) const {
+    return block_write_stamps_[physical_address / WriteBlockSize];
+  }
+  [[nodiscard]] std::size_t physical_address(const std::uint16_t address) const { return offset_for(address); }
+  // Reads without telling the listener, for tools that look at memory without the program doing so.
+  [[nodiscard]] std::uint8_t peek(const std::uint16_t address) const { return address_space_[offset_for(address)]; }
+
+  // Every byte, the paging and ROM flags; the contended pages, listener and write watcher stay as they are.
+  struct Checkpoint {
+    std::vector<std::uint8_t> contents;
+    std::array<std::uint8_t, 4> page_table{};
+    std::array<bool, 4> rom{};
+    std::uint64_t write_stamp{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const { return {address_space_, page_table_, rom_, write_stamp_}; }
+  // Brings `into`, an older checkpoint of this Memory or an empty one, up to date, copying only what's been written.
+  void checkpoint(Checkpoint &into) const;
+  // Only blocks with a newer write stamp than the checkpoint's can differ from it, so just those are copied back, as
+  // writes so that state hashes and decoded code caches notice. A checkpoint is only good for the Memory it came from.
+  void restore(const Checkpoint &checkpoint);
+
+  // Bulk helpers for the repeating block instructions. Neither notifies the listener nor honours ROM flags, so callers
+  // check those first; each range must stay within one page in the direction of travel (see contiguous_bytes()).
+  [[nodiscard]] bool is_rom(const std::uint16_t address) const { return rom_[address / page_size]; }
+  [[nodiscard]] std::size_t contiguous_bytes(const std::uint16_t address, const bool increment) const {
+    return increment ? page_size - address % page_size : address % page_size + 1;
+  }
+  // Copies byte by byte as the Z80 would, so overlapping ranges repeat their pattern just like a real LDIR.
+  void copy_block(std::uint16_t from, std::uint16_t to, std::size_t count, bool increment);
+  // Returns how many bytes precede the first `byte` in the range, or `count` if there isn't one.
+  [[nodiscard]] std::size_t find_byte(
+      std::uint16_t address, std::size_t count, bool increment, std::uint8_t byte) const;
+
+  // Watch writes to `size` bytes of `page` from `offset` (or nullptr to stop). Not owned, like the listener.
+  void watch_writes(WriteWatcher *watcher, std::uint8_t page, std::uint16_t offset, std::size_t size);
+  [[nodiscard]] bool watched(std::uint16_t address, std::size_t count, bool increment) const;
 
   // Set a memory access listener (or nullptr to disable)
   // Note: Memory does not own the listener - caller must ensure the listener outlives the Memory
   void set_listener(Listener *listener) { listener_ = listener; }
   [[nodiscard]] bool has_listener() const { return listener_ != nullptr; }
+  [[nodiscard]] Listener *listener() const { return listener_; }
 
   friend void write_to_memory(
       Memory &memory, std::uint16_t base_address, std::convertible_to<std::uint8_t> auto... bytes) {
@@ -61,11 +124,22 @@ private:
   std::array<bool, 4> rom_{true, false, false, false};
   std::array<std::uint8_t, 4> page_table_{0, 1, 2, 3};
   std::vector<std::uint8_t> address_space_{};
+  std::uint64_t dirty_pages_{};
+  std::uint64_t contended_pages_{};
+  std::uint64_t write_stamp_{};
+  std::vector<std::uint64_t> block_write_stamps_{};
   Listener *listener_{nullptr}; // Optional memory access listener (not owned)
+  WriteWatcher *watcher_{nullptr};
+  std::size_t watch_start_{};
+  std::size_t watch_size_{};
 
   [[nodiscard]] constexpr auto offset_for(const std::uint16_t address) const {
     return page_table_[address / page_size] * page_size + address % page_size;
   }
+  void note_write(const std::size_t physical_address) {
+    dirty_pages_ |= 1ull << (physical_address / page_size);
+    block_write_stamps_[physical_address / WriteBlockSize] = ++write_stamp_;
+  }
 };
 
 } // namespace specbolt
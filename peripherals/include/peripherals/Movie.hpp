@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+#endif
+
+namespace specbolt {
+
+// A recording of keyboard input, timestamped in emulated T-states relative to the start of the recording. Together
+// with a starting snapshot this is enough to replay a session bit-exactly.
+SPECBOLT_EXPORT
+class Movie {
+public:
+  struct Event {
+    std::size_t cycle{};
+    std::int32_t key_code{};
+    bool pressed{};
+    constexpr bool operator==(const Event &) const = default;
+  };
+
+  // Events must be recorded in non-decreasing cycle order.
+  void record(std::size_t cycle, std::int32_t key_code, bool pressed);
+
+  [[nodiscard]] const std::vector<Event> &events() const { return events_; }
+  [[nodiscard]] bool empty() const { return events_.empty(); }
+
+  [[nodiscard]] std::vector<std::uint8_t> serialise() const;
+  [[nodiscard]] static Movie deserialise(std::span<const std::uint8_t> data);
+
+  void save(const std::filesystem::path &path) const;
+  [[nodiscard]] static Movie load(const std::filesystem::path &path);
+
+private:
+  std::vector<Event> events_;
+};
+
+} // namespace specbolt
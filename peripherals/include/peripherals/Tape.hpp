@@ -9,6 +9,8 @@ namespace specbolt {
 
 SPECBOLT_EXPORT
 class Tape {
+  enum class State { Idle, Pilot, Sync1, Sync2, Data1, Data2, Pause };
+
 public:
   void load(const std::filesystem::path &path);
 
@@ -21,13 +23,35 @@ public:
   void stop();
   [[nodiscard]] bool playing() const { return state_ != State::Idle; }
 
+  // The playback position and level; the loaded blocks themselves aren't copied.
+  struct Checkpoint {
+    std::size_t num_edges{};
+    std::size_t next_transition{};
+    std::size_t bit_cycles{};
+    bool level{};
+    State state{};
+    std::size_t current_block_index{};
+    std::size_t bit_offset{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const {
+    return {num_edges_, next_transition_, bit_cycles_, level_, state_, current_block_index_, bit_offset_};
+  }
+  void restore(const Checkpoint &checkpoint) {
+    num_edges_ = checkpoint.num_edges;
+    next_transition_ = checkpoint.next_transition;
+    bit_cycles_ = checkpoint.bit_cycles;
+    level_ = checkpoint.level;
+    state_ = checkpoint.state;
+    current_block_index_ = checkpoint.current_block_index;
+    bit_offset_ = checkpoint.bit_offset;
+  }
+
 private:
   std::size_t num_edges_{};
   std::size_t next_transition_{};
   std::size_t bit_cycles_{};
   bool level_{};
 
-  enum class State { Idle, Pilot, Sync1, Sync2, Data1, Data2, Pause };
   State state_{State::Idle};
 
   std::size_t current_block_index_{};
@@ -19,7 +19,10 @@ public:
   static constexpr auto VisibleWidth = XBorder + ScreenWidth + XBorder;
   static constexpr auto VisibleHeight = YBorder + ScreenHeight + YBorder;
   static constexpr auto ColumnCount = ScreenWidth / 8;
+  static constexpr auto CellCount = VisibleWidth / 8;
   static constexpr auto CyclesPerScanLine = 224;
+  static constexpr auto LinesPerFrame = 312;
+  static constexpr auto CyclesPerFrame = static_cast<std::size_t>(LinesPerFrame * CyclesPerScanLine);
 
   explicit Video(const Memory &memory);
 
@@ -28,8 +31,55 @@ public:
   bool poll(std::size_t num_cycles);
   bool next_scan_line();
 
+  // Beam racing: rather than snapshotting each line as it starts, draw lazily, 8 pixels at a time, at the moment the
+  // beam would. catch_up() must be called with the current cycle before anything that changes what's drawn: a border
+  // change, a write to screen memory or a screen page switch. Left alone, a whole line is drawn at once on its
+  // next_scan_line(), so software that doesn't race the beam costs about the same as before.
+  void beam_racing(bool enable, std::size_t cycle);
+  [[nodiscard]] bool beam_racing() const { return beam_racing_; }
+  void catch_up(std::size_t cycle);
+
+  // With rendering off, lines are still timed and the interrupt still raised, but nothing is read from memory or drawn.
+  // Frames nobody will see needn't be rendered.
+  void rendering(const bool enable) { rendering_ = enable; }
+  [[nodiscard]] bool rendering() const { return rendering_; }
+
   void blit_to(std::span<std::uint32_t> screen, bool swap_rgb = false) const;
 
+  // The beam position, border, screen page and flash phase; not the lines already drawn, which the rerun redraws.
+  struct Checkpoint {
+    std::uint8_t border{};
+    std::uint8_t page{};
+    std::size_t total_cycles{};
+    std::size_t next_line_cycles{};
+    std::size_t current_line{};
+    std::size_t flash_counter{};
+    bool flash_on{};
+    std::size_t beam_line{};
+    std::size_t beam_cell{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const {
+    return {border_, page_, total_cycles_, next_line_cycles_, current_line_, flash_counter_, flash_on_, beam_line_,
+        beam_cell_};
+  }
+  void restore(const Checkpoint &checkpoint) {
+    border_ = checkpoint.border;
+    page_ = checkpoint.page;
+    total_cycles_ = checkpoint.total_cycles;
+    next_line_cycles_ = checkpoint.next_line_cycles;
+    current_line_ = checkpoint.current_line;
+    flash_counter_ = checkpoint.flash_counter;
+    flash_on_ = checkpoint.flash_on;
+    beam_line_ = checkpoint.beam_line;
+    beam_cell_ = checkpoint.beam_cell;
+  }
+
+  // How many T-states the ULA holds up a CPU access to contended memory, for each cycle of the frame. Index it by cycle
+  // count modulo the frame length: lines start on multiples of CyclesPerScanLine, just as next_scan_line() is run, and
+  // the first delay comes 14335 T-states after the line whose next_scan_line() raises the interrupt starts. The timings
+  // are the 48K's; the 128K's longer lines and shorter frame aren't modelled.
+  [[nodiscard]] static std::span<const std::uint8_t> contention_table();
+
 private:
   const Memory &memory_;
   std::uint8_t border_{3};
@@ -39,17 +89,24 @@ private:
   std::size_t current_line_{};
   std::size_t flash_counter_{};
   bool flash_on_{};
+  bool beam_racing_{};
+  bool rendering_{true};
+  // The next cell for the beam to draw, as a count of lines since cycle zero and a cell within that line.
+  std::size_t beam_line_{};
+  std::size_t beam_cell_{};
   struct ColumnRow {
     std::uint8_t attribute{};
     std::uint8_t pixel{};
   };
   struct Line {
-    std::uint8_t border_{};
+    // One border colour for each 8 pixels across, though only those outside the screen area are shown.
+    std::array<std::uint8_t, CellCount> border{};
     std::array<ColumnRow, ColumnCount> columns{};
   };
   std::array<Line, VisibleHeight> lines_{};
 
   void render_line(std::size_t display_line);
+  void render_cell(std::size_t display_line, std::size_t cell);
 };
 
 } // namespace specbolt
@@ -1,7 +1,9 @@
 export module peripherals;
 
 export import :Audio;
+export import :Ay;
 export import :Keyboard;
 export import :Memory;
+export import :Movie;
 export import :Tape;
 export import :Video;
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+#else
+#include "peripherals/Audio.hpp"
+#endif
+
+namespace specbolt {
+
+namespace {
+
+constexpr std::size_t ClockRate = 3'500'000;
+constexpr std::size_t CyclesPerFrame = ClockRate / 50;
+
+void write_sound_chip(Audio &audio, const std::size_t cycles, const std::uint8_t reg, const std::uint8_t value) {
+  audio.select_sound_chip_register(reg);
+  audio.write_sound_chip(cycles, value);
+}
+
+std::vector<std::int16_t> run_for_a_second(Audio &audio, std::size_t &cycles) {
+  std::vector<std::int16_t> samples;
+  for (auto frame = 0; frame < 50; ++frame) {
+    cycles += CyclesPerFrame;
+    const auto frame_samples = audio.end_frame(cycles);
+    samples.insert(samples.end(), frame_samples.begin(), frame_samples.end());
+  }
+  return samples;
+}
+
+std::size_t sign_changes(const std::vector<std::int16_t> &samples) {
+  std::size_t changes{};
+  for (auto i = 1uz; i < samples.size(); ++i) {
+    if ((samples[i - 1] < 0) != (samples[i] < 0))
+      ++changes;
+  }
+  return changes;
+}
+
+} // namespace
+
+TEST_CASE("sound chip tests", "[Audio]") {
+  Audio audio(44'100, ClockRate);
+  std::size_t cycles{};
+
+  SECTION("reads back registers without their unused bits") {
+    write_sound_chip(audio, 0, 1, 0xff);
+    write_sound_chip(audio, 0, 6, 0xff);
+    write_sound_chip(audio, 0, 7, 0xff);
+    audio.select_sound_chip_register(1);
+    CHECK(audio.read_sound_chip() == 0x0f);
+    audio.select_sound_chip_register(6);
+    CHECK(audio.read_sound_chip() == 0x1f);
+    audio.select_sound_chip_register(7);
+    CHECK(audio.read_sound_chip() == 0xff);
+    CHECK(audio.sound_chip_register() == 7);
+  }
+
+  SECTION("is silent until a channel is turned up") {
+    write_sound_chip(audio, 0, 7, 0x3e); // Tone on channel A only.
+    write_sound_chip(audio, 0, 1, 0x01);
+    const auto samples = run_for_a_second(audio, cycles);
+    REQUIRE(!samples.empty());
+    for (const auto sample: samples)
+      REQUIRE(sample == 0);
+  }
+
+  SECTION("plays a tone at the programmed pitch") {
+    write_sound_chip(audio, 0, 7, 0x3e);
+    // A period of 256 toggles every 4096 cycles, so a 3.5MHz clock gives a 427Hz square wave.
+    write_sound_chip(audio, 0, 1, 0x01);
+    write_sound_chip(audio, 0, 8, 0x0f);
+    static_cast<void>(run_for_a_second(audio, cycles)); // Let the high-pass filter settle.
+    const auto changes = sign_changes(run_for_a_second(audio, cycles));
+    CHECK(changes >= 2 * 420);
+    CHECK(changes <= 2 * 434);
+  }
+
+  SECTION("changes only what a program can read back while muted") {
+    Audio reference(44'100, ClockRate);
+    for (auto *each: {&audio, &reference}) {
+      write_sound_chip(*each, 0, 7, 0x3e);
+      write_sound_chip(*each, 0, 1, 0x01);
+      write_sound_chip(*each, 0, 8, 0x0f);
+    }
+    const auto checkpoint = audio.checkpoint();
+    audio.mute(true);
+    write_sound_chip(audio, 1000, 8, 0x00);
+    audio.set_output(2000, true, false);
+    CHECK(audio.read_sound_chip() == 0x00);
+    audio.restore(checkpoint);
+    audio.mute(false);
+    std::size_t reference_cycles{};
+    CHECK(run_for_a_second(audio, cycles) == run_for_a_second(reference, reference_cycles));
+  }
+}
+
+} // namespace specbolt
@@ -29,6 +29,39 @@ TEST_CASE("memory tests", "[Memory]") {
     }
   }
 
+  SECTION("contention follows the physical page") {
+    Memory memory{10};
+    memory.set_page_table({8, 5, 2, 0});
+    memory.set_contended_pages(1u << 5 | 1u << 7);
+    CHECK(!memory.contended(0x0000));
+    CHECK(memory.contended(0x4000));
+    CHECK(!memory.contended(0x8000));
+    CHECK(!memory.contended(0xc000));
+    memory.set_page_table({8, 5, 2, 7});
+    CHECK(memory.contended(0xffff));
+  }
+
+  SECTION("watches writes to a range") {
+    struct Counter final : Memory::WriteWatcher {
+      int writes{};
+      void before_write() override { ++writes; }
+    } counter;
+    Memory memory{4};
+    memory.set_rom_flags({false, false, false, false});
+    memory.watch_writes(&counter, 1, 0, 0x1b00);
+    memory.write(0x3fff, 1);
+    memory.write(0x4000, 1);
+    memory.write(0x5aff, 1);
+    memory.write(0x5b00, 1);
+    CHECK(counter.writes == 2);
+    CHECK(memory.watched(0x3ff0, 17, true));
+    CHECK(!memory.watched(0x3ff0, 16, true));
+    CHECK(!memory.watched(0x5b05, 6, false));
+    memory.watch_writes(nullptr, 1, 0, 0x1b00);
+    memory.write(0x4000, 1);
+    CHECK(counter.writes == 2);
+  }
+
   SECTION("Spectrum 128 like behaviour") {
     Memory memory{10}; // 8 16k banks, plus two roms
     memory.set_page_table({8, 5, 2, 0});
@@ -60,6 +93,49 @@ TEST_CASE("memory tests", "[Memory]") {
       }
     }
   }
+
+  SECTION("tracks dirty pages") {
+    Memory memory{10};
+    memory.set_page_table({8, 5, 2, 7});
+    memory.clear_dirty_pages();
+    memory.write(0x0000, 0x12); // ROM, so not dirtied
+    memory.write(0xc000, 0x34);
+    memory.raw_write(3, 0x10, 0x56);
+    CHECK(memory.dirty_pages() == ((1u << 7) | (1u << 3)));
+    memory.clear_dirty_pages();
+    CHECK(memory.dirty_pages() == 0);
+    CHECK(memory.page_data(3)[0x10] == 0x56);
+  }
+
+  SECTION("restores only the blocks written since a checkpoint") {
+    Memory memory{4};
+    memory.set_rom_flags({false, false, false, false});
+    memory.write(0x1234, 0x11);
+    const auto checkpoint = memory.checkpoint();
+    memory.write(0x1234, 0x22);
+    memory.write(0x8000, 0x33);
+    memory.clear_dirty_pages();
+    const auto untouched_stamp = memory.block_write_stamp(0x4000);
+    memory.restore(checkpoint);
+    CHECK(memory.read(0x1234) == 0x11);
+    CHECK(memory.read(0x8000) == 0x00);
+    CHECK(memory.dirty_pages() == ((1u << 0) | (1u << 2)));
+    CHECK(memory.block_write_stamp(0x4000) == untouched_stamp);
+    CHECK(memory.block_write_stamp(0x1200) > checkpoint.write_stamp);
+
+    SECTION("and brings checkpoints up to date") {
+      auto updated = checkpoint;
+      memory.write(0x4000, 0x44);
+      memory.checkpoint(updated);
+      memory.write(0x4000, 0x55);
+      memory.write(0x1234, 0x66);
+      memory.restore(updated);
+      CHECK(memory.read(0x4000) == 0x44);
+      CHECK(memory.read(0x1234) == 0x11);
+      memory.restore(checkpoint);
+      CHECK(memory.read(0x4000) == 0x00);
+    }
+  }
 }
 
 } // namespace specbolt
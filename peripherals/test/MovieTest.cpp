@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+#else
+#include "peripherals/Movie.hpp"
+#endif
+
+namespace specbolt {
+
+TEST_CASE("movie tests", "[Movie]") {
+  SECTION("round trips through serialisation") {
+    Movie movie;
+    movie.record(0, 'a', true);
+    movie.record(69'888, 'a', false);
+    movie.record(69'888, 0x400000e1, true);
+    movie.record(1'000'000'000'000, ' ', false);
+    const auto loaded = Movie::deserialise(movie.serialise());
+    CHECK(loaded.events() == movie.events());
+  }
+
+  SECTION("is compact") {
+    Movie movie;
+    movie.record(1'000, 'q', true);
+    movie.record(2'000, 'q', false);
+    // Magic and version, then two bytes of delta and one of key code per event.
+    CHECK(movie.serialise().size() == 5 + 2 * 3);
+  }
+
+  SECTION("rejects out of order events") {
+    Movie movie;
+    movie.record(100, 'a', true);
+    CHECK_THROWS_AS(movie.record(99, 'a', false), std::runtime_error);
+  }
+
+  SECTION("rejects bad data") {
+    CHECK_THROWS_AS(Movie::deserialise(std::vector<std::uint8_t>{'N', 'O', 'P', 'E', 1}), std::runtime_error);
+    CHECK_THROWS_AS(Movie::deserialise(std::vector<std::uint8_t>{'S', 'B', 'M', 'V', 1, 0x80}), std::runtime_error);
+  }
+}
+
+} // namespace specbolt
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+#else
+#include "peripherals/Memory.hpp"
+#include "peripherals/Video.hpp"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace specbolt {
+
+TEST_CASE("contention is timed from the interrupt", "[Video]") {
+  Memory memory{4};
+  Video video{memory};
+  video.rendering(false);
+  // Each next_scan_line() is run as its line starts.
+  std::size_t interrupt{};
+  for (auto line = 0uz; line < Video::LinesPerFrame; ++line) {
+    if (video.next_scan_line())
+      interrupt = line * Video::CyclesPerScanLine;
+  }
+  const auto table = Video::contention_table();
+  REQUIRE(table.size() == Video::CyclesPerFrame);
+  const auto delay_at = [&](const std::size_t since_interrupt) {
+    return table[(interrupt + since_interrupt) % table.size()];
+  };
+  CHECK(delay_at(14334) == 0);
+  CHECK(delay_at(14335) == 6);
+  CHECK(delay_at(14336) == 5);
+  CHECK(delay_at(14341) == 0);
+  CHECK(delay_at(14343) == 6);
+  // The last delay of the first screen line, and none in its right border.
+  CHECK(delay_at(14335 + 125) == 1);
+  CHECK(delay_at(14335 + 128) == 0);
+  // The next line starts 224 T-states later.
+  CHECK(delay_at(14335 + 224) == 6);
+}
+
+TEST_CASE("beam racing draws changes made partway through a line", "[Video]") {
+  Memory memory{4};
+  Video video{memory};
+  video.set_border(1);
+  video.beam_racing(true, 0);
+  // The top screen line is all ink, blue for now.
+  for (auto column = 0u; column < Video::ColumnCount; ++column) {
+    memory.raw_write(1, static_cast<std::uint16_t>(column), 0xff);
+    memory.raw_write(1, static_cast<std::uint16_t>(0x1800 + column), 0x01);
+  }
+
+  // It starts 88 lines into the frame, and the beam draws 8 pixels every 4 T-states from there.
+  constexpr auto LineStart = 88uz * Video::CyclesPerScanLine;
+  // Halfway across the screen, the ink turns red.
+  video.catch_up(LineStart + 16 * 4);
+  for (auto column = 0u; column < Video::ColumnCount; ++column)
+    memory.raw_write(1, static_cast<std::uint16_t>(0x1800 + column), 0x02);
+  // Halfway across the right border, the border turns green.
+  video.catch_up(LineStart + 34 * 4);
+  video.set_border(4);
+  video.catch_up(LineStart + 2 * Video::CyclesPerScanLine);
+
+  std::vector<std::uint32_t> screen(Video::VisibleWidth * Video::VisibleHeight);
+  video.blit_to(screen);
+  constexpr auto Blue = 0xff0000cdu;
+  constexpr auto Red = 0xffcd0000u;
+  constexpr auto Green = 0xff00cd00u;
+  const auto pixel = [&](const std::size_t x, const std::size_t y) { return screen[y * Video::VisibleWidth + x]; };
+  constexpr auto Y = static_cast<std::size_t>(Video::YBorder);
+  constexpr auto X = static_cast<std::size_t>(Video::XBorder);
+  // The left border, and the screen up to the change.
+  CHECK(pixel(0, Y) == Blue);
+  CHECK(pixel(X - 1, Y) == Blue);
+  CHECK(pixel(X, Y) == Blue);
+  CHECK(pixel(X + 16 * 8 - 1, Y) == Blue);
+  // The screen after it.
+  CHECK(pixel(X + 16 * 8, Y) == Red);
+  CHECK(pixel(X + Video::ScreenWidth - 1, Y) == Red);
+  // The right border either side of its change.
+  CHECK(pixel(X + Video::ScreenWidth, Y) == Blue);
+  CHECK(pixel(X + Video::ScreenWidth + 15, Y) == Blue);
+  CHECK(pixel(X + Video::ScreenWidth + 16, Y) == Green);
+  CHECK(pixel(Video::VisibleWidth - 1, Y) == Green);
+  // The lines either side were drawn whole.
+  CHECK(pixel(Video::VisibleWidth - 1, Y - 1) == Blue);
+  CHECK(pixel(0, Y + 1) == Green);
+}
+
+TEST_CASE("frames run without rendering keep their timing but draw nothing", "[Video]") {
+  Memory memory{4};
+  // Blue ink everywhere, on a blue border.
+  for (auto offset = 0u; offset < 0x1800; ++offset)
+    memory.raw_write(1, static_cast<std::uint16_t>(offset), 0xff);
+  for (auto offset = 0x1800u; offset < 0x1b00; ++offset)
+    memory.raw_write(1, static_cast<std::uint16_t>(offset), 0x01);
+  constexpr auto Blue = 0xff0000cdu;
+  constexpr auto Black = 0xff000000u;
+
+  for (const bool beam_racing: {false, true}) {
+    INFO("beam racing " << beam_racing);
+    Video rendered{memory};
+    Video skipped{memory};
+    skipped.rendering(false);
+    // The cycles at which each raises the interrupt, polled in uneven steps as instructions would.
+    std::vector<std::size_t> rendered_interrupts;
+    std::vector<std::size_t> skipped_interrupts;
+    for (auto *video: {&rendered, &skipped}) {
+      video->set_border(1);
+      video->beam_racing(beam_racing, 0);
+      auto &interrupts = video == &rendered ? rendered_interrupts : skipped_interrupts;
+      std::size_t cycle{};
+      for (auto step = 0uz; cycle < 3 * Video::CyclesPerFrame; ++step) {
+        const auto cycles = 4 + step % 20;
+        cycle += cycles;
+        video->catch_up(cycle);
+        if (video->poll(cycles))
+          interrupts.push_back(cycle);
+      }
+    }
+    CHECK(rendered_interrupts.size() == 3);
+    CHECK(skipped_interrupts == rendered_interrupts);
+    const auto rendered_state = rendered.checkpoint();
+    const auto skipped_state = skipped.checkpoint();
+    CHECK(skipped_state.total_cycles == rendered_state.total_cycles);
+    CHECK(skipped_state.next_line_cycles == rendered_state.next_line_cycles);
+    CHECK(skipped_state.current_line == rendered_state.current_line);
+    CHECK(skipped_state.flash_counter == rendered_state.flash_counter);
+    CHECK(skipped_state.beam_line == rendered_state.beam_line);
+    CHECK(skipped_state.beam_cell == rendered_state.beam_cell);
+
+    std::vector<std::uint32_t> screen(Video::VisibleWidth * Video::VisibleHeight);
+    rendered.blit_to(screen);
+    CHECK(std::ranges::all_of(screen, [&](const std::uint32_t pixel) { return pixel == Blue; }));
+    skipped.blit_to(screen);
+    CHECK(std::ranges::all_of(screen, [&](const std::uint32_t pixel) { return pixel == Black; }));
+  }
+}
+
+} // namespace specbolt
@@ -33,6 +33,9 @@ public:
   void increase_opacity();
   void decrease_opacity();
 
+  // Record only one in every `period` memory accesses
+  void set_sampling(const std::uint32_t period) { heatmap_.set_sampling(period); }
+
   // Process keyboard input for controlling the heatmap
   bool process_key(SDL_Keycode key);
 
@@ -10,31 +10,46 @@ namespace specbolt {
 MemoryHeatmap::MemoryHeatmap() {
   // Initialize the pixel buffer
   texture_pixels_.resize(HEATMAP_WIDTH * HEATMAP_HEIGHT, 0);
+  live_cells_.reserve(MEMORY_SIZE);
+  set_decay_rate(decay_rate_);
 }
 
 void MemoryHeatmap::reset() {
   // Reset all counters to zero
-  read_counts_.fill(0.0f);
-  write_counts_.fill(0.0f);
+  read_counts_.fill(0);
+  write_counts_.fill(0);
+  live_cells_.clear();
+  live_.reset();
+  texture_stale_ = true;
 }
 
-void MemoryHeatmap::record_read(const std::uint16_t address) {
-  if (mode_ == Mode::ReadOnly || mode_ == Mode::ReadWrite) {
-    read_counts_[address] += 1.0f;
+void MemoryHeatmap::set_decay_rate(const float rate) {
+  decay_rate_ = rate;
+  // Decay already owed by untouched cells is recalculated at the new rate, which is close enough for a display.
+  for (std::size_t epochs = 0; epochs < DecayTableSize; ++epochs) {
+    const auto factor = std::pow(std::min(rate, 1.0f), static_cast<float>(epochs));
+    decay_table_[epochs] = static_cast<std::uint32_t>(factor * 65536.0f);
   }
+  if (rate < 1.0f)
+    decay_table_.back() = 0;
 }
 
-void MemoryHeatmap::record_write(const std::uint16_t address) {
-  if (mode_ == Mode::WriteOnly || mode_ == Mode::ReadWrite) {
-    write_counts_[address] += 1.0f;
-  }
+void MemoryHeatmap::catch_up(const std::uint16_t address) {
+  const auto missed = static_cast<std::size_t>(epoch_ - cell_epochs_[address]);
+  if (!missed)
+    return;
+  const auto factor = decay_table_[std::min(missed, DecayTableSize - 1)];
+  read_counts_[address] = static_cast<std::uint32_t>(std::uint64_t{read_counts_[address]} * factor >> 16);
+  write_counts_[address] = static_cast<std::uint32_t>(std::uint64_t{write_counts_[address]} * factor >> 16);
+  cell_epochs_[address] = epoch_;
 }
 
-void MemoryHeatmap::decay() {
-  // Apply decay to all counters
-  if (decay_rate_ < 1.0f) {
-    std::ranges::for_each(read_counts_, [this](auto &count) { count *= decay_rate_; });
-    std::ranges::for_each(write_counts_, [this](auto &count) { count *= decay_rate_; });
+void MemoryHeatmap::record(Counts &counts, const std::uint16_t address) {
+  catch_up(address);
+  counts[address] += std::min(HitWeight, 0xffffffff - counts[address]);
+  if (!live_[address]) {
+    live_[address] = true;
+    live_cells_.push_back(address);
   }
 }
 
@@ -89,58 +104,57 @@ std::uint32_t MemoryHeatmap::get_colour_for_value(float value) const {
   }
 }
 
-void MemoryHeatmap::update_texture(SDL_Renderer *renderer) {
-  // Find the maximum count for normalization
-  constexpr float epsilon = 0.1f; // Small epsilon to avoid division by zero
-  float max_count = epsilon;
-
-  // Calculate the maximum based on current mode
-  if (mode_ == Mode::ReadOnly) {
-    max_count = std::ranges::max(read_counts_);
-  }
-  else if (mode_ == Mode::WriteOnly) {
-    max_count = std::ranges::max(write_counts_);
-  }
-  else if (mode_ == Mode::ReadWrite) {
-    const auto max_read = std::ranges::max(read_counts_);
-    const auto max_write = std::ranges::max(write_counts_);
-    max_count = std::max(max_read, max_write);
+void MemoryHeatmap::build_colour_lut() {
+  for (std::size_t level = 0; level < ColourLevels; ++level) {
+    // Apply logarithmic scaling to better visualize the range
+    constexpr float log_scale_factor = 9.0f;
+    constexpr float log_base = 10.0f;
+    const auto value = static_cast<float>(level) / static_cast<float>(ColourLevels - 1);
+    colour_lut_[level] = get_colour_for_value(std::log1p(value * log_scale_factor) / std::log(log_base));
   }
+}
 
-  // Ensure we have a valid maximum
-  max_count = std::max(max_count, epsilon);
-
-  // Update the pixel buffer
-  for (std::size_t address = 0; address < MEMORY_SIZE; address++) {
-    // Calculate the pixel position
-    const std::size_t x = address & 0xFF; // Low byte determines X
-    const std::size_t y = address >> 8; // High byte determines Y
-
-    // Get the normalized value based on the current mode
-    float value;
-    if (mode_ == Mode::ReadOnly) {
-      value = read_counts_[address] / max_count;
-    }
-    else if (mode_ == Mode::WriteOnly) {
-      value = write_counts_[address] / max_count;
-    }
-    else if (mode_ == Mode::ReadWrite) {
-      value = (read_counts_[address] + write_counts_[address]) / max_count;
-    }
-    else {
-      value = 0.0f;
+void MemoryHeatmap::update_texture(SDL_Renderer *renderer) {
+  // Get the count to display for a cell based on the current mode
+  const auto count_for = [this](const std::uint16_t address) -> std::uint64_t {
+    switch (mode_) {
+      case Mode::ReadOnly: return read_counts_[address];
+      case Mode::WriteOnly: return write_counts_[address];
+      case Mode::ReadWrite: return std::uint64_t{read_counts_[address]} + write_counts_[address];
+      default: return 0;
     }
+  };
 
-    // Apply logarithmic scaling to better visualize the range
-    constexpr float log_scale_factor = 9.0f;
-    constexpr float log_base = 10.0f;
-    value = std::log1p(value * log_scale_factor) / std::log(log_base);
+  // Untouched cells all share the colour of zero, so only need drawing when the colours change
+  if (texture_stale_) {
+    build_colour_lut();
+    std::ranges::fill(texture_pixels_, colour_lut_[0]);
+    texture_stale_ = false;
+  }
 
-    // Set the pixel colour
-    const std::size_t pixel_index = y * HEATMAP_WIDTH + x;
-    texture_pixels_[pixel_index] = get_colour_for_value(value);
+  // Bring the live cells up to date and find the maximum count for normalization
+  std::uint64_t max_count = 1;
+  for (const auto address: live_cells_) {
+    catch_up(address);
+    max_count = std::max(max_count, count_for(address));
   }
 
+  // Quantise each live cell's count to a colour table index with a fixed-point multiply; count <= max_count keeps the
+  // product within 64 bits and the index within the table.
+  const auto scale = (std::uint64_t{ColourLevels - 1} << 32) / max_count;
+
+  // Update the pixels of the live cells, retiring any that have decayed away entirely. The pixel index is the
+  // address itself: the low byte determines X and the high byte Y.
+  std::erase_if(live_cells_, [&](const std::uint16_t address) {
+    if (!read_counts_[address] && !write_counts_[address]) {
+      live_[address] = false;
+      texture_pixels_[address] = colour_lut_[0];
+      return true;
+    }
+    texture_pixels_[address] = colour_lut_[count_for(address) * scale >> 32];
+    return false;
+  });
+
   // Create or recreate the texture if needed
   if (texture_ == nullptr) {
     constexpr Uint32 pixel_format = SDL_PIXELFORMAT_ARGB8888;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bitset>
 #include <cstdint>
 #include <vector>
 
@@ -31,25 +33,42 @@ public:
   void reset();
 
   // Record a memory access
-  void record_read(std::uint16_t address);
-  void record_write(std::uint16_t address);
+  void record_read(std::uint16_t address) {
+    if ((mode_ == Mode::ReadOnly || mode_ == Mode::ReadWrite) && sampled())
+      record(read_counts_, address);
+  }
+  void record_write(std::uint16_t address) {
+    if ((mode_ == Mode::WriteOnly || mode_ == Mode::ReadWrite) && sampled())
+      record(write_counts_, address);
+  }
+
+  // Only record one in every `period` accesses. The map shows relative counts, so this costs resolution, not shape.
+  void set_sampling(const std::uint32_t period) { sample_period_ = sample_countdown_ = std::max(period, 1u); }
+  [[nodiscard]] std::uint32_t sampling() const { return sample_period_; }
 
   // Visualization mode control
   void set_mode(const Mode mode) { mode_ = mode; }
   [[nodiscard]] Mode mode() const { return mode_; }
 
-  void set_colour_scheme(const ColourScheme scheme) { colour_scheme_ = scheme; }
+  void set_colour_scheme(const ColourScheme scheme) {
+    colour_scheme_ = scheme;
+    texture_stale_ = true;
+  }
   [[nodiscard]] ColourScheme colour_scheme() const { return colour_scheme_; }
 
   // Configure heatmap appearance
-  void set_opacity(const float opacity) { opacity_ = opacity; }
+  void set_opacity(const float opacity) {
+    opacity_ = opacity;
+    texture_stale_ = true;
+  }
   [[nodiscard]] float opacity() const { return opacity_; }
 
-  void set_decay_rate(const float rate) { decay_rate_ = rate; }
+  void set_decay_rate(float rate);
   [[nodiscard]] float decay_rate() const { return decay_rate_; }
 
-  // Apply decay to all counters, called periodically
-  void decay();
+  // Apply decay to all counters, called periodically. This only starts a new epoch; each cell catches up with the
+  // decay it missed when it is next touched or drawn.
+  void decay() { ++epoch_; }
 
   // Render the heatmap as an overlay
   void render(SDL_Renderer *renderer, const SDL_Rect &dest_rect);
@@ -61,9 +80,27 @@ private:
   // The ZX Spectrum has 64K of addressable memory
   static constexpr std::size_t MEMORY_SIZE = 64 * 1024;
 
-  // Access counters for each memory address
-  std::array<float, MEMORY_SIZE> read_counts_{};
-  std::array<float, MEMORY_SIZE> write_counts_{};
+  // Saturating access counters for each memory address, in 16.16 fixed point so that even a single hit fades gradually
+  // rather than dropping straight to zero on the first decay. They top out at 65535 hits: with the default decay, a
+  // cell only gets there by being hit over 3000 times every epoch.
+  using Counts = std::array<std::uint32_t, MEMORY_SIZE>;
+  static constexpr std::uint32_t HitWeight = 1u << 16;
+  Counts read_counts_{};
+  Counts write_counts_{};
+
+  // The decay epoch each cell's counts are up to date with, and the 16.16 fixed-point decay to apply after missing
+  // a given number of epochs. Counts have always decayed away entirely by the end of the table.
+  std::uint32_t epoch_{};
+  std::array<std::uint32_t, MEMORY_SIZE> cell_epochs_{};
+  static constexpr std::size_t DecayTableSize = 256;
+  std::array<std::uint32_t, DecayTableSize> decay_table_{};
+
+  // Cells with non-zero counts; only these need decaying and drawing.
+  std::vector<std::uint16_t> live_cells_;
+  std::bitset<MEMORY_SIZE> live_;
+
+  std::uint32_t sample_period_ = 1;
+  std::uint32_t sample_countdown_ = 1;
 
   // Current mode and settings
   Mode mode_ = Mode::ReadWrite;
@@ -75,11 +112,27 @@ private:
   static constexpr int HEATMAP_WIDTH = 256; // 16 addresses per pixel horizontally
   static constexpr int HEATMAP_HEIGHT = 256; // 16 addresses per pixel vertically
 
-  // Texture and pixels for rendering
+  // Texture and pixels for rendering. The pixels of dead cells are only redrawn when the colours change.
   SDL_Texture *texture_ = nullptr;
   std::vector<std::uint32_t> texture_pixels_;
+  bool texture_stale_ = true;
+
+  // Counts are quantised to one of ColourLevels levels, and each level's colour (log scaling, scheme and opacity
+  // included) is looked up rather than computed per cell. Rebuilt along with the stale texture.
+  static constexpr std::size_t ColourLevels = 256;
+  std::array<std::uint32_t, ColourLevels> colour_lut_{};
+
+  [[nodiscard]] bool sampled() {
+    if (--sample_countdown_)
+      return false;
+    sample_countdown_ = sample_period_;
+    return true;
+  }
+  void record(Counts &counts, std::uint16_t address);
+  void catch_up(std::uint16_t address);
 
   // Helper methods for visualization
+  void build_colour_lut();
   void update_texture(SDL_Renderer *renderer);
   [[nodiscard]] std::uint32_t get_colour_for_value(float value) const;
 };
@@ -1,5 +1,6 @@
 #include "heatmap/heatmap_renderer.hpp"
 #include "sdl_wrapper.hpp"
+#include "trace/TraceFile.hpp"
 
 #include <chrono>
 #include <filesystem>
@@ -16,6 +17,7 @@ import z80_v1;
 import z80_v2;
 import z80_v3;
 #else
+#include "peripherals/Movie.hpp"
 #include "peripherals/Video.hpp"
 #include "spectrum/Assets.hpp"
 #include "spectrum/Snapshot.hpp"
@@ -46,14 +48,21 @@ struct SdlApp {
   std::filesystem::path rom;
   std::filesystem::path snapshot;
   std::filesystem::path tape;
+  std::filesystem::path record_movie;
+  std::filesystem::path play_movie;
   bool need_help{};
   std::size_t trace_instructions{};
+  std::filesystem::path trace_file;
   int impl{1};
   double video_refresh_rate{50};
   double emulator_speed{1};
   double zoom{4};
   bool spec128{};
   bool enable_heatmap{false};
+  std::uint32_t heatmap_sampling{1};
+  bool contention{};
+  bool beam_racing{};
+  std::size_t run_ahead{};
 
   int Main(const int argc, const char *argv[]) {
     const auto cli = lyra::cli() //
@@ -61,12 +70,19 @@ struct SdlApp {
                      | lyra::opt(spec128)["--128"]("Use the 128K Spectrum") //
                      | lyra::opt(rom, "ROM")["--rom"]("Where to find the ROM") //
                      | lyra::opt(trace_instructions, "NUM")["--trace"]("Trace the first NUM instructions") //
+                     | lyra::opt(trace_file, "FILE")["--trace-file"]("Write the trace to FILE in binary") //
                      | lyra::opt(impl, "impl")["--impl"]("Use the specified implementation.") //
                      | lyra::opt(video_refresh_rate, "HZ")["--video-refresh"]("Refresh the video at HZ") //
                      | lyra::opt(emulator_speed, "X")["--emulator-speed"]("Multiplier on emulation speed") //
                      | lyra::opt(zoom, "X")["--zoom"]("Multiplier on display zoom") //
                      | lyra::opt(tape, "TAPE")["--tape"]("Queue up TAPE") //
+                     | lyra::opt(record_movie, "MOVIE")["--record"]("Record keyboard input to MOVIE on exit") //
+                     | lyra::opt(play_movie, "MOVIE")["--replay"]("Replay keyboard input from MOVIE") //
                      | lyra::opt(enable_heatmap)["--heatmap"]("Enable memory access heatmap") //
+                     | lyra::opt(heatmap_sampling, "N")["--heatmap-sampling"]("Heatmap one in N accesses") //
+                     | lyra::opt(contention)["--contention"]("Emulate ULA memory contention (48K, impl 2 or 3)") //
+                     | lyra::opt(beam_racing)["--beam-racing"]("Draw the screen as the beam does") //
+                     | lyra::opt(run_ahead, "FRAMES")["--run-ahead"]("Show the picture FRAMES ahead to hide lag") //
                      | lyra::arg(snapshot, "SNAPSHOT")("Snapshot to load");
     if (const auto parse_result = cli.parse({argc, argv}); !parse_result) {
       std::println(std::cerr, "Error in command line: {}", parse_result.message());
@@ -122,20 +138,32 @@ struct SdlApp {
     Spectrum<Z80Impl> spectrum(spec128 ? Variant::Spectrum128 : Variant::Spectrum48, rom,
         static_cast<std::size_t>(audio.freq()), emulator_speed);
     const v1::Disassembler dis{spectrum.memory()};
+    spectrum.contention(contention);
+    spectrum.beam_racing(beam_racing);
 
     if (!snapshot.empty()) {
-      Snapshot::load(snapshot, spectrum.z80());
+      Snapshot::load(snapshot, spectrum);
     }
 
     if (!tape.empty()) {
       spectrum.tape().load(tape);
     }
 
+    // Decode binary traces with specbolt_trace.
+    std::optional<TraceFileWriter> trace_writer;
+    if (!trace_file.empty())
+      trace_writer.emplace(trace_file);
     if (trace_instructions)
-      spectrum.trace_next(trace_instructions);
+      spectrum.trace_next(trace_instructions, trace_writer ? &*trace_writer : nullptr);
+
+    if (!play_movie.empty())
+      spectrum.play_movie(Movie::load(play_movie));
+    if (!record_movie.empty())
+      spectrum.start_recording();
 
     bool quit = false;
     bool z80_running{true};
+    bool fast_forward{};
 
     // Only create the heatmap renderer if enabled
     std::optional<HeatmapRenderer> heatmap_renderer;
@@ -143,9 +171,12 @@ struct SdlApp {
       // Use emplace to construct the object in-place
       // Constructor will handle connecting and enabling
       heatmap_renderer.emplace(spectrum.memory());
+      heatmap_renderer->set_sampling(heatmap_sampling);
     }
 
-    auto next_print = std::chrono::high_resolution_clock::now() + std::chrono::seconds(1);
+    auto last_print = std::chrono::high_resolution_clock::now();
+    auto next_print = last_print + std::chrono::seconds(1);
+    std::size_t fast_forward_frames{};
     auto next_emu_frame = std::chrono::high_resolution_clock::now();
     auto next_display_frame = std::chrono::high_resolution_clock::now();
     const auto video_delay = std::chrono::microseconds(static_cast<unsigned long>(1'000'000 / video_refresh_rate));
@@ -163,20 +194,48 @@ struct SdlApp {
 
             if (sdl_event.key.keysym.sym == SDLK_F1)
               spectrum.play();
-            spectrum.keyboard().key_down(sdl_event.key.keysym.sym);
+            if (sdl_event.key.keysym.sym == SDLK_F12) {
+              fast_forward = true;
+              break;
+            }
+            spectrum.key_down(sdl_event.key.keysym.sym);
             break;
           }
-          case SDL_KEYUP: spectrum.keyboard().key_up(sdl_event.key.keysym.sym); break;
+          case SDL_KEYUP:
+            if (sdl_event.key.keysym.sym == SDLK_F12) {
+              fast_forward = false;
+              next_emu_frame = std::chrono::high_resolution_clock::now();
+              break;
+            }
+            spectrum.key_up(sdl_event.key.keysym.sym);
+            break;
           default: break;
         }
       }
 
       const auto now = std::chrono::high_resolution_clock::now();
-      if (now > next_emu_frame) {
+      if (now > next_emu_frame || fast_forward) {
         if (z80_running) {
           const auto start_time = std::chrono::high_resolution_clock::now();
           try {
-            const auto cycles_elapsed = spectrum.run_frame();
+            std::size_t cycles_elapsed{};
+            if (fast_forward) {
+              // Emulate flat out until the next display frame, keeping only the last frame's picture and sound. That
+              // plays a frame of sound per display frame, so it keeps pace with the audio device, if choppily.
+              spectrum.rendering(false);
+              do {
+                cycles_elapsed += spectrum.run_frame();
+                ++fast_forward_frames;
+                static_cast<void>(spectrum.audio().end_frame(spectrum.z80().cycle_count()));
+              } while (std::chrono::high_resolution_clock::now() - start_time < video_delay);
+              spectrum.rendering(true);
+              cycles_elapsed += spectrum.run_frame();
+              ++fast_forward_frames;
+              next_emu_frame = now;
+            }
+            else {
+              cycles_elapsed = spectrum.run_frame_ahead(run_ahead);
+            }
             const auto end_time = std::chrono::high_resolution_clock::now();
             const auto time_taken = end_time - start_time;
             const auto cycles_per_second =
@@ -186,7 +245,17 @@ struct SdlApp {
             audio.queue(spectrum.audio().end_frame(spectrum.z80().cycle_count()));
 
             if (end_time > next_print) {
-              std::println("Virtual: {:.2f}MHz | lag {}", cycles_per_second / 1'000'000, now - next_emu_frame);
+              const std::chrono::duration<double> since_print = end_time - last_print;
+              // Against the Spectrum's own 50 frames a second.
+              if (fast_forward_frames > 0) {
+                std::println("Virtual: {:.2f}MHz | fast-forward {:.1f}x", cycles_per_second / 1'000'000,
+                    static_cast<double>(fast_forward_frames) / since_print.count() / 50);
+              }
+              else {
+                std::println("Virtual: {:.2f}MHz | lag {}", cycles_per_second / 1'000'000, now - next_emu_frame);
+              }
+              fast_forward_frames = 0;
+              last_print = end_time;
               next_print = end_time + std::chrono::seconds(1);
             }
           }
@@ -226,6 +295,10 @@ struct SdlApp {
         next_display_frame += video_delay;
       }
     }
+    if (!record_movie.empty()) {
+      spectrum.stop_recording().save(record_movie);
+      std::println("Saved movie to '{}'", record_movie.string());
+    }
     return 0;
   }
 };
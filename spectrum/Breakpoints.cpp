@@ -0,0 +1,329 @@
+#ifndef SPECBOLT_MODULES
+#include "spectrum/Breakpoints.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+#include <utility>
+#endif
+
+namespace specbolt {
+
+namespace {
+
+struct NamedRegister {
+  std::string_view name;
+  std::uint32_t index;
+};
+
+constexpr std::array<NamedRegister, 8> Registers8{{
+    {"a", static_cast<std::uint32_t>(RegisterFile::R8::A)},
+    {"f", static_cast<std::uint32_t>(RegisterFile::R8::F)},
+    {"b", static_cast<std::uint32_t>(RegisterFile::R8::B)},
+    {"c", static_cast<std::uint32_t>(RegisterFile::R8::C)},
+    {"d", static_cast<std::uint32_t>(RegisterFile::R8::D)},
+    {"e", static_cast<std::uint32_t>(RegisterFile::R8::E)},
+    {"h", static_cast<std::uint32_t>(RegisterFile::R8::H)},
+    {"l", static_cast<std::uint32_t>(RegisterFile::R8::L)},
+}};
+
+constexpr std::array<NamedRegister, 7> Registers16{{
+    {"af", static_cast<std::uint32_t>(RegisterFile::R16::AF)},
+    {"bc", static_cast<std::uint32_t>(RegisterFile::R16::BC)},
+    {"de", static_cast<std::uint32_t>(RegisterFile::R16::DE)},
+    {"hl", static_cast<std::uint32_t>(RegisterFile::R16::HL)},
+    {"ix", static_cast<std::uint32_t>(RegisterFile::R16::IX)},
+    {"iy", static_cast<std::uint32_t>(RegisterFile::R16::IY)},
+    {"sp", static_cast<std::uint32_t>(RegisterFile::R16::SP)},
+}};
+
+constexpr std::array<std::string_view, 3> SpecialRegisters{"pc", "i", "r"};
+
+} // namespace
+
+// A recursive descent parser emitting the program in postfix order as it goes.
+class Condition::Parser {
+public:
+  Parser(const std::string_view text, std::vector<Instruction> &program) : text_(text), program_(program) {}
+
+  void parse() {
+    logical_or();
+    skip_space();
+    if (pos_ != text_.size())
+      fail("unexpected input");
+  }
+
+private:
+  std::string_view text_;
+  std::size_t pos_{};
+  std::vector<Instruction> &program_;
+
+  [[noreturn]] void fail(const std::string_view what) const {
+    throw std::runtime_error(std::format("Bad condition '{}': {} at column {}", text_, what, pos_ + 1));
+  }
+
+  void skip_space() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+      ++pos_;
+  }
+  [[nodiscard]] bool peek(const std::string_view token) {
+    skip_space();
+    return text_.substr(pos_).starts_with(token);
+  }
+  // Accepts `token` unless it's the start of the longer `unless`, so "&" doesn't swallow half of "&&".
+  bool accept(const std::string_view token, const std::string_view unless = {}) {
+    if (!peek(token) || (!unless.empty() && peek(unless)))
+      return false;
+    pos_ += token.size();
+    return true;
+  }
+  void expect(const std::string_view token) {
+    if (!accept(token))
+      fail(std::format("expected '{}'", token));
+  }
+  void emit(const Op op, const std::uint32_t operand = 0) { program_.push_back(Instruction{op, operand}); }
+
+  void logical_or() {
+    logical_and();
+    while (accept("||")) {
+      logical_and();
+      emit(Op::LogicalOr);
+    }
+  }
+  void logical_and() {
+    comparison();
+    while (accept("&&")) {
+      comparison();
+      emit(Op::LogicalAnd);
+    }
+  }
+  void comparison() {
+    bit_or();
+    static constexpr std::array<std::pair<std::string_view, Op>, 6> Comparisons{{
+        {"==", Op::Equal},
+        {"!=", Op::NotEqual},
+        {"<=", Op::LessEqual},
+        {">=", Op::GreaterEqual},
+        {"<", Op::Less},
+        {">", Op::Greater},
+    }};
+    for (const auto &[token, op]: Comparisons) {
+      if (accept(token)) {
+        bit_or();
+        emit(op);
+        return;
+      }
+    }
+  }
+  void bit_or() {
+    bit_and();
+    while (accept("|", "||")) {
+      bit_and();
+      emit(Op::BitOr);
+    }
+  }
+  void bit_and() {
+    sum();
+    while (accept("&", "&&")) {
+      sum();
+      emit(Op::BitAnd);
+    }
+  }
+  void sum() {
+    unary();
+    for (;;) {
+      if (accept("+")) {
+        unary();
+        emit(Op::Add);
+      }
+      else if (accept("-")) {
+        unary();
+        emit(Op::Sub);
+      }
+      else {
+        return;
+      }
+    }
+  }
+  void unary() {
+    if (accept("!", "!=")) {
+      unary();
+      emit(Op::Not);
+      return;
+    }
+    if (accept("(")) {
+      logical_or();
+      expect(")");
+      return;
+    }
+    if (accept("[")) {
+      logical_or();
+      expect("]");
+      emit(Op::Peek);
+      return;
+    }
+    skip_space();
+    if (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) {
+      number();
+      return;
+    }
+    identifier();
+  }
+  void number() {
+    const bool hex = peek("0x");
+    const auto start = hex ? pos_ + 2 : pos_;
+    auto end = start;
+    while (end < text_.size() && (hex ? std::isxdigit(static_cast<unsigned char>(text_[end]))
+                                      : std::isdigit(static_cast<unsigned char>(text_[end]))))
+      ++end;
+    if (end == start)
+      fail("expected a number");
+    if (end - start > 8)
+      fail("number too large");
+    const auto value = std::stoul(std::string(text_.substr(start, end - start)), nullptr, hex ? 16 : 10);
+    pos_ = end;
+    emit(Op::Push, static_cast<std::uint32_t>(value));
+  }
+  void identifier() {
+    auto end = pos_;
+    while (end < text_.size() && std::isalpha(static_cast<unsigned char>(text_[end])))
+      ++end;
+    std::string name(text_.substr(pos_, end - pos_));
+    std::ranges::transform(name, name.begin(), [](const char c) { return static_cast<char>(std::tolower(c)); });
+    if (name.empty())
+      fail("expected a number, register or bracket");
+    pos_ = end;
+    for (const auto &[reg_name, index]: Registers8) {
+      if (name == reg_name)
+        return emit(Op::Reg8, index);
+    }
+    for (const auto &[reg_name, index]: Registers16) {
+      if (name == reg_name)
+        return emit(Op::Reg16, index);
+    }
+    for (auto index = 0uz; index < SpecialRegisters.size(); ++index) {
+      if (name == SpecialRegisters[index])
+        return emit(Op::Special, static_cast<std::uint32_t>(index));
+    }
+    fail(std::format("unknown register '{}'", name));
+  }
+};
+
+Condition::Condition(const std::string_view expression) : expression_(expression) {
+  Parser(expression, program_).parse();
+  std::size_t depth{};
+  for (const auto &[op, operand]: program_) {
+    switch (op) {
+      case Op::Push:
+      case Op::Reg8:
+      case Op::Reg16:
+      case Op::Special:
+        if (++depth > MaxDepth)
+          throw std::runtime_error(std::format("Condition '{}' is too deeply nested", expression));
+        break;
+      case Op::Peek:
+      case Op::Not: break;
+      default: --depth; break;
+    }
+  }
+}
+
+bool Condition::evaluate(const RegisterFile &regs, const Memory &memory) const {
+  std::array<std::uint32_t, MaxDepth> stack;
+  std::size_t top{};
+  for (const auto &[op, operand]: program_) {
+    switch (op) {
+      case Op::Push: stack[top++] = operand; break;
+      case Op::Reg8: stack[top++] = regs.get(static_cast<RegisterFile::R8>(operand)); break;
+      case Op::Reg16: stack[top++] = regs.get(static_cast<RegisterFile::R16>(operand)); break;
+      case Op::Special: stack[top++] = operand == 0 ? regs.pc() : operand == 1 ? regs.i() : regs.r(); break;
+      case Op::Peek: stack[top - 1] = memory.peek(static_cast<std::uint16_t>(stack[top - 1])); break;
+      case Op::Not: stack[top - 1] = !stack[top - 1]; break;
+      default: {
+        const auto rhs = stack[--top];
+        auto &lhs = stack[top - 1];
+        switch (op) {
+          case Op::Add: lhs += rhs; break;
+          case Op::Sub: lhs -= rhs; break;
+          case Op::BitAnd: lhs &= rhs; break;
+          case Op::BitOr: lhs |= rhs; break;
+          case Op::Equal: lhs = lhs == rhs; break;
+          case Op::NotEqual: lhs = lhs != rhs; break;
+          case Op::Less: lhs = lhs < rhs; break;
+          case Op::LessEqual: lhs = lhs <= rhs; break;
+          case Op::Greater: lhs = lhs > rhs; break;
+          case Op::GreaterEqual: lhs = lhs >= rhs; break;
+          case Op::LogicalAnd: lhs = lhs && rhs; break;
+          case Op::LogicalOr: lhs = lhs || rhs; break;
+          default: std::unreachable();
+        }
+        break;
+      }
+    }
+  }
+  return stack[0] != 0;
+}
+
+void Breakpoints::add_breakpoint(const std::uint16_t pc, std::optional<Condition> condition) {
+  pc_.set(pc);
+  if (condition)
+    conditions_.insert_or_assign(pc, std::move(*condition));
+  else
+    conditions_.erase(pc);
+}
+
+void Breakpoints::remove_breakpoint(const std::uint16_t pc) {
+  pc_.reset(pc);
+  conditions_.erase(pc);
+}
+
+void Breakpoints::watch(std::bitset<AddressSpace> &watch, std::uint64_t &pages, const std::uint16_t address,
+    const std::size_t size, const bool enable) {
+  for (auto offset = 0uz; offset < size; ++offset)
+    watch.set(static_cast<std::uint16_t>(address + offset), enable);
+  // A page stays in the mask for as long as anything in it is watched.
+  pages = 0;
+  for (auto watched = 0uz; watched < AddressSpace; ++watched) {
+    if (watch[watched])
+      pages |= std::uint64_t{1} << (watched / PageSize);
+  }
+}
+
+void Breakpoints::watch_reads(const std::uint16_t address, const std::size_t size) {
+  watch(read_watch_, read_pages_, address, size, true);
+}
+
+void Breakpoints::watch_writes(const std::uint16_t address, const std::size_t size) {
+  watch(write_watch_, write_pages_, address, size, true);
+}
+
+void Breakpoints::unwatch_reads(const std::uint16_t address, const std::size_t size) {
+  watch(read_watch_, read_pages_, address, size, false);
+}
+
+void Breakpoints::unwatch_writes(const std::uint16_t address, const std::size_t size) {
+  watch(write_watch_, write_pages_, address, size, false);
+}
+
+void Breakpoints::clear() {
+  pc_.reset();
+  conditions_.clear();
+  read_watch_.reset();
+  write_watch_.reset();
+  read_pages_ = write_pages_ = 0;
+  watch_hit_.reset();
+  hit_.reset();
+}
+
+std::vector<std::uint16_t> Breakpoints::breakpoints() const {
+  std::vector<std::uint16_t> result;
+  for (auto pc = 0uz; pc < AddressSpace; ++pc) {
+    if (pc_[pc])
+      result.push_back(static_cast<std::uint16_t>(pc));
+  }
+  return result;
+}
+
+} // namespace specbolt
@@ -0,0 +1,25 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module spectrum:Breakpoints;
+
+import peripherals;
+import z80_common;
+
+#include "spectrum/Breakpoints.hpp"
+
+#include "Breakpoints.cpp"
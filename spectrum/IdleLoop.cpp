@@ -0,0 +1,46 @@
+#ifndef SPECBOLT_MODULES
+#include "spectrum/IdleLoop.hpp"
+
+#include <algorithm>
+#endif
+
+namespace specbolt {
+
+IdleLoopDetector::Skip IdleLoopDetector::on_backward_jump(const Z80Base &z80, RegisterFile regs,
+    const std::size_t io_count, const std::size_t next_event, const std::size_t end_cycle) {
+  const auto now = z80.cycle_count();
+  const auto r = regs.r();
+  const auto refreshes = static_cast<std::size_t>((r - regs_.r()) & 0x7f);
+  // R is the one register that's expected to move on each trip.
+  regs.r(regs_.r());
+  const auto write_stamp = z80.memory().write_stamp();
+  // A contended access could be held up for a different time on the next trip round.
+  const auto contended_accesses = z80.contended_accesses();
+  const bool same_again = now > cycle_ && now - cycle_ <= MaxTripCycles && regs == regs_ && z80.iff1() == iff1_ &&
+                          z80.iff2() == iff2_ && write_stamp == write_stamp_ && io_count == io_count_ &&
+                          contended_accesses == contended_accesses_ && next_event == next_event_ && !z80.halted() &&
+                          !z80.interrupt_pending() && !z80.memory().has_listener();
+  if (!same_again) {
+    regs_ = regs;
+    regs_.r(r);
+    iff1_ = z80.iff1();
+    iff2_ = z80.iff2();
+    write_stamp_ = write_stamp;
+    io_count_ = io_count;
+    contended_accesses_ = contended_accesses;
+    next_event_ = next_event;
+    cycle_ = now;
+    return {};
+  }
+
+  // Stopping short of the next task means it runs at exactly the point in the loop it would have anyway.
+  const auto trip = now - cycle_;
+  const auto trips =
+      next_event > now && end_cycle > now ? std::min((next_event - now - 1) / trip, (end_cycle - now) / trip) : 0uz;
+  // Carry on from where the skip leaves off, so the next trip round can be skipped straight away too.
+  cycle_ = now + trips * trip;
+  regs_.r(static_cast<std::uint8_t>((r & 0x80) | ((r + trips * refreshes) & 0x7f)));
+  return {trips * trip, trips * refreshes};
+}
+
+} // namespace specbolt
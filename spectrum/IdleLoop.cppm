@@ -0,0 +1,14 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+export module spectrum:IdleLoop;
+
+import peripherals;
+import z80_common;
+
+#include "spectrum/IdleLoop.hpp"
+
+#include "IdleLoop.cpp"
@@ -10,6 +10,7 @@
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <optional>
 #include <ranges>
 #include <stdexcept>
 #include <vector>
@@ -187,7 +188,7 @@ void Snapshot::load_sna(const std::filesystem::path &snapshot, Z80Base &z80) {
   z80.regs().sp(static_cast<std::uint16_t>(z80.regs().sp() + 2));
 }
 
-void Snapshot::load_z80(const std::filesystem::path &snapshot, Z80Base &z80) {
+Snapshot::Hardware Snapshot::load_z80(const std::filesystem::path &snapshot, Z80Base &z80) {
   std::ifstream load_stream(snapshot, std::ios::binary);
   if (!load_stream) {
     throw std::runtime_error(std::format("Failed to open file '{}': {}", snapshot.string(), std::strerror(errno)));
@@ -233,6 +234,7 @@ void Snapshot::load_z80(const std::filesystem::path &snapshot, Z80Base &z80) {
   z80.iff2(header.iff2);
   z80.irq_mode(header.flag2 & 0x3);
 
+  Hardware hardware;
   if (header.pc_h || header.pc_l) {
     z80.regs().pc(static_cast<std::uint16_t>(header.pc_h << 8 | header.pc_l));
     if (header.flag1 & (1 << 5)) {
@@ -279,6 +281,11 @@ void Snapshot::load_z80(const std::filesystem::path &snapshot, Z80Base &z80) {
         throw std::runtime_error(std::format("Unable to read file '{}'", snapshot.string()));
       z80.regs().pc(extended_header.pc);
       variant = extended_header.hw_mode == 0 ? Variant::Spectrum48 : Variant::Spectrum128; // TODO not this
+      // Bit 2 of the emulator flags says a 48K snapshot used an AY too.
+      if (variant == Variant::Spectrum128 || extended_header.emu_flags & 0x04) {
+        hardware.sound_chip_registers = extended_header.sound_chip_regs;
+        hardware.sound_chip_selected = extended_header.last_port_fffd;
+      }
     };
     switch (header_len) {
       case sizeof(Z80HeaderV2): handle_load.operator()<Z80HeaderV2>(); break;
@@ -311,13 +318,16 @@ void Snapshot::load_z80(const std::filesystem::path &snapshot, Z80Base &z80) {
         z80.memory().raw_write_checked(ram_bank, static_cast<std::uint16_t>(i), chunk[i]);
     }
   }
+  return hardware;
 }
 
-void Snapshot::load(const std::filesystem::path &snapshot, Z80Base &z80) {
+Snapshot::Hardware Snapshot::load_into(const std::filesystem::path &snapshot, Z80Base &z80) {
   if (snapshot.extension() == ".z80")
     return load_z80(snapshot, z80);
-  if (snapshot.extension() == ".sna")
-    return load_sna(snapshot, z80);
+  if (snapshot.extension() == ".sna") {
+    load_sna(snapshot, z80);
+    return {};
+  }
   throw std::runtime_error(std::format("Unsupported snapshot format: {}", snapshot.string()));
 }
 
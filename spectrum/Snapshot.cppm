@@ -7,6 +7,7 @@ module;
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <stdexcept>
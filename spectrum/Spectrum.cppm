@@ -5,14 +5,22 @@ module;
 #include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <print>
 #include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 
 export module spectrum:Spectrum;
 
+import :Breakpoints;
+import :IdleLoop;
+import :StateHash;
+import :Trace;
 import peripherals;
 import z80_common;
 
@@ -0,0 +1,67 @@
+#ifndef SPECBOLT_MODULES
+#include "spectrum/StateHash.hpp"
+
+#include "z80/common/Flags.hpp"
+
+#include <cstring>
+#endif
+
+namespace specbolt {
+
+namespace {
+
+// A multiply-xorshift mixer: not cryptographic, just fast with good avalanche.
+constexpr std::uint64_t mix(std::uint64_t hash, const std::uint64_t value) {
+  hash ^= value;
+  hash *= 0x9e3779b97f4a7c15ull;
+  return hash ^ (hash >> 29);
+}
+
+constexpr std::uint64_t Seed = 0x5bd1e9955bd1e995ull;
+
+} // namespace
+
+std::uint64_t StateHasher::hash_bytes(const std::span<const std::uint8_t> bytes) {
+  auto hash = mix(Seed, bytes.size());
+  auto remaining = bytes;
+  for (; remaining.size() >= sizeof(std::uint64_t); remaining = remaining.subspan(sizeof(std::uint64_t))) {
+    std::uint64_t word;
+    std::memcpy(&word, remaining.data(), sizeof(word));
+    hash = mix(hash, word);
+  }
+  for (const auto byte: remaining)
+    hash = mix(hash, byte);
+  return hash;
+}
+
+std::uint64_t StateHasher::hash_registers(const RegisterFile &regs) {
+  using R16 = RegisterFile::R16;
+  // Undocumented flag bits are masked, matching the trace output; they're not something the cores agree on yet. R is
+  // left out too: it only becomes observable once copied elsewhere, at which point the divergence shows up anyway.
+  static constexpr auto UndocMask = static_cast<std::uint16_t>(0xff00 | ~(Flags::Flag3() | Flags::Flag5()).to_u8());
+  auto hash = mix(Seed, regs.get(R16::AF) & UndocMask);
+  for (const auto r16: {R16::BC, R16::DE, R16::HL, R16::AF_, R16::BC_, R16::DE_, R16::HL_, R16::SP, R16::IX, R16::IY})
+    hash = mix(hash, regs.get(r16));
+  hash = mix(hash, regs.pc());
+  return mix(hash, regs.i());
+}
+
+std::uint64_t StateHasher::hash(const RegisterFile &regs, Memory &memory) {
+  const auto num_pages = memory.num_pages();
+  const auto dirty = page_hashes_.size() == num_pages ? memory.dirty_pages() : ~0ull;
+  page_hashes_.resize(num_pages);
+  memory.clear_dirty_pages();
+
+  auto hash = hash_registers(regs);
+  for (auto page = 0uz; page < num_pages; ++page) {
+    if (dirty & (1ull << page))
+      page_hashes_[page] = hash_bytes(memory.page_data(static_cast<std::uint8_t>(page)));
+    hash = mix(hash, page_hashes_[page]);
+  }
+  // The paging state decides what the CPU sees, so it's part of the machine state too.
+  for (const auto page: memory.page_table())
+    hash = mix(hash, page);
+  return hash;
+}
+
+} // namespace specbolt
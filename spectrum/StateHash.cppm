@@ -0,0 +1,15 @@
+module;
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+export module spectrum:StateHash;
+
+import peripherals;
+import z80_common;
+
+#include "spectrum/StateHash.hpp"
+
+#include "StateHash.cpp"
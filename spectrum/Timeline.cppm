@@ -0,0 +1,17 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+export module spectrum:Timeline;
+
+import :Breakpoints;
+import :Spectrum;
+import z80_common;
+
+#include "spectrum/Timeline.hpp"
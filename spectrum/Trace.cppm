@@ -0,0 +1,8 @@
+module;
+
+#include <array>
+#include <cstdint>
+
+export module spectrum:Trace;
+
+#include "spectrum/Trace.hpp"
@@ -0,0 +1,149 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include "peripherals/Memory.hpp"
+#include "z80/common/RegisterFile.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#endif
+
+namespace specbolt {
+
+// A breakpoint condition such as "a == 0x10 && [hl] != 0", compiled once into a little stack-machine program so that
+// checking it on every hit is cheap. Operands are numbers (decimal or 0x hex), register names, and memory bytes as
+// [address]; operators are ! + - & | == != < <= > >= && ||, and parentheses group. Precedence is C's except that &
+// and | bind tighter than comparisons, so "hl & 0xff00 == 0x4000" means what it looks like. Arithmetic is unsigned.
+SPECBOLT_EXPORT
+class Condition {
+public:
+  // Throws std::runtime_error describing the problem if `expression` doesn't parse.
+  explicit Condition(std::string_view expression);
+
+  // Takes the concrete core rather than Z80Base, whose registers can hold a stale F when flags are evaluated lazily.
+  template<typename Z80Impl>
+  [[nodiscard]] bool operator()(const Z80Impl &z80) const {
+    return evaluate(z80.regs(), z80.memory());
+  }
+  [[nodiscard]] const std::string &expression() const { return expression_; }
+
+private:
+  enum class Op : std::uint8_t {
+    Push,
+    Reg8,
+    Reg16,
+    Special, // PC, I or R, which have no RegisterFile enumerator.
+    Peek,
+    Not,
+    Add,
+    Sub,
+    BitAnd,
+    BitOr,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    LogicalAnd,
+    LogicalOr
+  };
+  struct Instruction {
+    Op op;
+    std::uint32_t operand;
+  };
+
+  static constexpr std::size_t MaxDepth = 32;
+
+  std::string expression_;
+  std::vector<Instruction> program_;
+
+  [[nodiscard]] bool evaluate(const RegisterFile &regs, const Memory &memory) const;
+
+  class Parser;
+};
+
+// PC breakpoints and memory watchpoints for a debugger's run loop. A breakpoint costs one bitmap test per instruction
+// until it's hit. Watchpoints listen to memory, which is only attached while there are any; each access first checks a
+// per-1K-page mask so accesses to unwatched pages cost next to nothing.
+SPECBOLT_EXPORT
+class Breakpoints final : public Memory::Listener {
+public:
+  struct Hit {
+    enum class Kind { Breakpoint, Read, Write };
+    Kind kind;
+    std::uint16_t address;
+  };
+
+  void add_breakpoint(std::uint16_t pc, std::optional<Condition> condition = std::nullopt);
+  void remove_breakpoint(std::uint16_t pc);
+  void watch_reads(std::uint16_t address, std::size_t size = 1);
+  void watch_writes(std::uint16_t address, std::size_t size = 1);
+  void unwatch_reads(std::uint16_t address, std::size_t size = 1);
+  void unwatch_writes(std::uint16_t address, std::size_t size = 1);
+  void clear();
+
+  [[nodiscard]] std::vector<std::uint16_t> breakpoints() const;
+  [[nodiscard]] const Condition *condition_for(const std::uint16_t pc) const {
+    const auto found = conditions_.find(pc);
+    return found == conditions_.end() ? nullptr : &found->second;
+  }
+  [[nodiscard]] bool has_breakpoints() const { return pc_.any(); }
+  [[nodiscard]] bool has_watchpoints() const { return read_pages_ || write_pages_; }
+
+  // Called after each instruction: has a watchpoint fired during it, or is there a breakpoint at the new PC whose
+  // condition holds? The hit stays available until the next check.
+  template<typename Z80Impl>
+  [[nodiscard]] bool check(const Z80Impl &z80) {
+    hit_.reset();
+    if (watch_hit_) {
+      hit_ = watch_hit_;
+      watch_hit_.reset();
+      return true;
+    }
+    if (const auto pc = z80.pc(); pc_[pc] && condition_holds(pc, z80)) [[unlikely]] {
+      hit_ = Hit{Hit::Kind::Breakpoint, pc};
+      return true;
+    }
+    return false;
+  }
+  [[nodiscard]] const std::optional<Hit> &hit() const { return hit_; }
+
+  void on_memory_read(const std::uint16_t address) override {
+    if (read_pages_ >> (address / PageSize) & 1 && read_watch_[address]) [[unlikely]]
+      watch_hit_ = Hit{Hit::Kind::Read, address};
+  }
+  void on_memory_write(const std::uint16_t address) override {
+    if (write_pages_ >> (address / PageSize) & 1 && write_watch_[address]) [[unlikely]]
+      watch_hit_ = Hit{Hit::Kind::Write, address};
+  }
+
+private:
+  static constexpr std::size_t AddressSpace = 0x10000;
+  static constexpr std::size_t PageSize = AddressSpace / 64;
+
+  std::bitset<AddressSpace> pc_;
+  std::unordered_map<std::uint16_t, Condition> conditions_;
+  std::bitset<AddressSpace> read_watch_;
+  std::bitset<AddressSpace> write_watch_;
+  std::uint64_t read_pages_{};
+  std::uint64_t write_pages_{};
+  std::optional<Hit> watch_hit_;
+  std::optional<Hit> hit_;
+
+  template<typename Z80Impl>
+  [[nodiscard]] bool condition_holds(const std::uint16_t pc, const Z80Impl &z80) const {
+    const auto found = conditions_.find(pc);
+    return found == conditions_.end() || found->second(z80);
+  }
+  static void watch(
+      std::bitset<AddressSpace> &watch, std::uint64_t &pages, std::uint16_t address, std::size_t size, bool enable);
+};
+
+} // namespace specbolt
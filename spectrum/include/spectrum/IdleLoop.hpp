@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include "z80/common/RegisterFile.hpp"
+#include "z80/common/Z80Base.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#endif
+
+namespace specbolt {
+
+// Spots the CPU going round a short loop that can't make progress until the next scheduled task: it arrives back at the
+// same address with the same registers, having written no memory and made no port access that matters. Every further
+// trip round is then identical, so the trips before the next task can be skipped, passing only time and R.
+SPECBOLT_EXPORT
+class IdleLoopDetector {
+public:
+  struct Skip {
+    std::size_t cycles{};
+    std::size_t refreshes{};
+  };
+
+  // Called whenever execution jumps backwards or to itself. `io_count` counts the port accesses that rule a loop out,
+  // and `next_event` is the cycle the next task is due; neither may change during a trip. Returns what to skip: whole
+  // trips ending before `next_event`, and no later than `end_cycle`.
+  // Takes the concrete core so that its registers, F included, are read as it sees them.
+  template<typename Z80Impl>
+  [[nodiscard]] Skip on_backward_jump(
+      const Z80Impl &z80, const std::size_t io_count, const std::size_t next_event, const std::size_t end_cycle) {
+    return on_backward_jump(z80, z80.regs(), io_count, next_event, end_cycle);
+  }
+
+private:
+  [[nodiscard]] Skip on_backward_jump(const Z80Base &z80, RegisterFile regs, std::size_t io_count,
+      std::size_t next_event, std::size_t end_cycle);
+
+  // Anything longer is unlikely to be waiting, and takes longer to confirm than it's worth.
+  static constexpr std::size_t MaxTripCycles = 512;
+
+  RegisterFile regs_{};
+  bool iff1_{};
+  bool iff2_{};
+  std::uint64_t write_stamp_{};
+  std::size_t io_count_{};
+  std::size_t contended_accesses_{};
+  std::size_t next_event_{};
+  std::size_t cycle_{};
+};
+
+} // namespace specbolt
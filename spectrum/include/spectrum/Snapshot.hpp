@@ -1,9 +1,14 @@
 #pragma once
 
 #ifndef SPECBOLT_MODULES
+#include "peripherals/Ay.hpp"
+#include "spectrum/Spectrum.hpp"
 #include "z80/common/Z80Base.hpp"
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
 #endif
 
 namespace specbolt {
@@ -11,9 +16,31 @@ namespace specbolt {
 SPECBOLT_EXPORT
 class Snapshot {
 public:
+  // State beyond the CPU and memory that some formats record, for the machine to restore.
+  struct Hardware {
+    std::optional<std::array<std::uint8_t, Ay::NumRegisters>> sound_chip_registers;
+    std::uint8_t sound_chip_selected{};
+  };
+
+  // Takes the concrete core so its own restore() runs once the registers are in: a core that defers its flags has to
+  // drop whatever it had pending, or the snapshot's F would be overridden by it.
+  template<typename Z80Impl>
+  static Hardware load(const std::filesystem::path &snapshot, Z80Impl &z80) {
+    const auto hardware = load_into(snapshot, z80);
+    z80.restore(z80.Z80Base::checkpoint());
+    return hardware;
+  }
+
+  template<typename Z80Impl>
+  static void load(const std::filesystem::path &snapshot, Spectrum<Z80Impl> &spectrum) {
+    if (const auto hardware = load(snapshot, spectrum.z80()); hardware.sound_chip_registers)
+      spectrum.load_sound_chip(*hardware.sound_chip_registers, hardware.sound_chip_selected);
+  }
+
+private:
   static void load_sna(const std::filesystem::path &snapshot, Z80Base &z80);
-  static void load_z80(const std::filesystem::path &snapshot, Z80Base &z80);
-  static void load(const std::filesystem::path &snapshot, Z80Base &z80);
+  static Hardware load_z80(const std::filesystem::path &snapshot, Z80Base &z80);
+  static Hardware load_into(const std::filesystem::path &snapshot, Z80Base &z80);
 };
 
 } // namespace specbolt
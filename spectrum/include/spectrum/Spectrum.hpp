@@ -4,8 +4,13 @@
 #include "peripherals/Audio.hpp"
 #include "peripherals/Keyboard.hpp"
 #include "peripherals/Memory.hpp"
+#include "peripherals/Movie.hpp"
 #include "peripherals/Tape.hpp"
 #include "peripherals/Video.hpp"
+#include "spectrum/Breakpoints.hpp"
+#include "spectrum/IdleLoop.hpp"
+#include "spectrum/StateHash.hpp"
+#include "spectrum/Trace.hpp"
 
 #include "z80/common/Flags.hpp"
 #include "z80/common/RegisterFile.hpp"
@@ -14,7 +19,11 @@
 #include <array>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <print>
+#include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 #endif
@@ -40,14 +49,18 @@ public:
     memory_.load(rom, rom_base_page_for(variant), 0, SpectrumRomSize);
     memory_.set_rom_flags({true, false, false, false});
     memory_.set_page_table(page_table_for(variant));
+    memory_.set_contended_pages(contended_pages_for(variant));
+    z80_.accelerate_block_ops(true);
     z80_.add_out_handler([this](const std::uint16_t port, const std::uint8_t value) {
+      ++io_count_;
       if ((port & 0xff) == 0xfe) {
+        video_.catch_up(z80_.cycle_count());
         video_.set_border(value & 0x07);
         audio_.set_output(z80_.cycle_count(), value & 0x10, value & 0x8);
       }
     });
     if (variant == Variant::Spectrum128) {
-      video_.set_page(5);
+      set_screen_page(5);
       z80_.add_out_handler([this](const std::uint16_t port, const std::uint8_t value) mutable {
         if (paging_disabled_)
           return;
@@ -59,9 +72,21 @@ public:
               static_cast<std::uint8_t>(value & 0x07),
           });
           paging_disabled_ = value & 0x20;
-          video_.set_page(static_cast<std::uint8_t>(value & 0x08 ? 7 : 5));
+          set_screen_page(static_cast<std::uint8_t>(value & 0x08 ? 7 : 5));
         }
       });
+      // The AY only decodes A15, A14 and A1.
+      z80_.add_out_handler([this](const std::uint16_t port, const std::uint8_t value) {
+        if ((port & 0xc002) == 0xc000)
+          audio_.select_sound_chip_register(value);
+        else if ((port & 0xc002) == 0x8000)
+          audio_.write_sound_chip(z80_.cycle_count(), value);
+      });
+      z80_.add_in_handler([this](const std::uint16_t port) -> std::optional<std::uint8_t> {
+        if ((port & 0xc002) == 0xc000)
+          return audio_.read_sound_chip();
+        return std::nullopt;
+      });
     }
     z80_.add_in_handler([this](const std::uint16_t port) { return keyboard_.in(port); });
     // Handler for ULA sound...
@@ -69,6 +94,9 @@ public:
       if (port & 1)
         return std::nullopt;
       maybe_detect_loading();
+      // Polling the keyboard is fine for an idle loop, unless the tape or the loading heuristic could see a difference.
+      if (tape_.playing() || reads_in_a_row_)
+        ++io_count_;
       const auto ear_bit = tape_.level() ? 0x40 : 0x00;
       return std::make_optional<std::uint8_t>(~(1 << 6) | ear_bit);
     });
@@ -80,29 +108,118 @@ public:
     const auto initial_cycles = z80_.cycle_count();
     const auto end_cycles = initial_cycles + cycles;
     const bool might_need_tracing = trace_next_instructions_ > 0;
+    if (!keep_history && !might_need_tracing) {
+      while (z80_.cycle_count() < end_cycles) {
+        const auto pc = z80_.pc();
+        // Cores with a block cache can run whole straight-line blocks when nothing needs to observe each instruction.
+        if constexpr (requires { z80_.execute_block(end_cycles); })
+          z80_.execute_block(end_cycles);
+        else
+          z80_.execute_one();
+        // Every loop ends by jumping backwards (or to itself), so only then might we be spinning idly.
+        if (z80_.pc() <= pc) [[unlikely]]
+          skip_idle_loop(end_cycles);
+      }
+      return z80_.cycle_count() - initial_cycles;
+    }
     while (z80_.cycle_count() < end_cycles) {
       if (keep_history) {
         reg_history_[current_reg_history_index_ % RegHistory] = z80_.regs();
         ++current_reg_history_index_;
       }
       if (might_need_tracing && trace_next_instructions_ && !z80_.halted()) [[unlikely]] {
-        static constexpr auto UndocMask =
-            static_cast<std::uint16_t>(0xff00 | ~(Flags::Flag3() | Flags::Flag5()).to_u8());
-        const auto time_taken = z80_.cycle_count() - last_traced_instr_cycle_count_;
-        last_traced_instr_cycle_count_ = z80_.cycle_count();
-        std::print(std::cout, "{:02} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x}\n", time_taken, z80_.pc(),
-            z80_.regs().get(RegisterFile::R16::AF) & UndocMask, z80_.regs().get(RegisterFile::R16::BC),
-            z80_.regs().get(RegisterFile::R16::DE), z80_.regs().get(RegisterFile::R16::HL), z80_.regs().ix(),
-            z80_.regs().iy(), z80_.regs().sp());
+        if (trace_sink_) {
+          trace_sink_->record(capture_trace());
+        }
+        else {
+          static constexpr auto UndocMask =
+              static_cast<std::uint16_t>(0xff00 | ~(Flags::Flag3() | Flags::Flag5()).to_u8());
+          const auto time_taken = z80_.cycle_count() - last_traced_instr_cycle_count_;
+          last_traced_instr_cycle_count_ = z80_.cycle_count();
+          std::print(std::cout, "{:02} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x}\n", time_taken,
+              z80_.pc(), z80_.regs().get(RegisterFile::R16::AF) & UndocMask, z80_.regs().get(RegisterFile::R16::BC),
+              z80_.regs().get(RegisterFile::R16::DE), z80_.regs().get(RegisterFile::R16::HL), z80_.regs().ix(),
+              z80_.regs().iy(), z80_.regs().sp());
+        }
         --trace_next_instructions_;
       }
       z80_.execute_one();
+      ++instructions_;
     }
     return z80_.cycle_count() - initial_cycles;
   }
 
   std::size_t run_frame() { return run_cycles(cycles_per_frame, false); }
 
+  // Runs for up to `cycles`, stopping early after the instruction that hits one of `breakpoints`, or once
+  // instructions() reaches `until_instruction`. Keeps the history like run_cycles(), but checks only the breakpoint
+  // bitmap between instructions. Returns whether anything was hit.
+  bool run_until_break(Breakpoints &breakpoints, const std::size_t cycles,
+      const std::uint64_t until_instruction = std::numeric_limits<std::uint64_t>::max()) {
+    const auto end_cycles = z80_.cycle_count() + cycles;
+    // Watchpoints need to see every access, which also turns off the bulk block operations.
+    struct RestoreListener {
+      Memory &memory;
+      Memory::Listener *listener;
+      ~RestoreListener() { memory.set_listener(listener); }
+    } restore{memory_, memory_.listener()};
+    if (breakpoints.has_watchpoints())
+      memory_.set_listener(&breakpoints);
+    while (z80_.cycle_count() < end_cycles && instructions_ < until_instruction) {
+      reg_history_[current_reg_history_index_ % RegHistory] = z80_.regs();
+      ++current_reg_history_index_;
+      z80_.execute_one();
+      ++instructions_;
+      if (breakpoints.check(z80_))
+        return true;
+    }
+    return false;
+  }
+
+  // Counts the instructions run one at a time: by run_cycles() when keeping history or tracing, and by
+  // run_until_break(). Debuggers, which only use those, can treat it as a timeline. The fast path doesn't count.
+  [[nodiscard]] std::uint64_t instructions() const { return instructions_; }
+
+  // Runs a batch of frames but only renders the last, for when nobody will see the rest.
+  std::size_t run_frames(const std::size_t frames) {
+    const auto was_rendering = video_.rendering();
+    std::size_t cycles{};
+    for (auto frame = 0uz; frame < frames; ++frame) {
+      video_.rendering(was_rendering && frame + 1 == frames);
+      cycles += run_frame();
+    }
+    video_.rendering(was_rendering);
+    return cycles;
+  }
+  // Run-ahead: runs a frame, then `frames` more with the current input, only to show their picture, and takes the
+  // machine back to the end of the first. A keypress the program takes a frame or two to respond to shows up that much
+  // sooner. Only the first frame makes any sound, and nothing else, such as a memory listener, sees the frames ahead.
+  std::size_t run_frame_ahead(const std::size_t frames) {
+    if (frames == 0 || trace_next_instructions_ > 0)
+      return run_frame();
+    const auto was_rendering = video_.rendering();
+    video_.rendering(false);
+    const auto cycles = run_frame();
+    video_.rendering(was_rendering);
+    checkpoint(run_ahead_);
+    struct Ahead {
+      Spectrum &spectrum;
+      Memory::Listener *listener;
+      ~Ahead() {
+        spectrum.restore(spectrum.run_ahead_);
+        spectrum.memory_.set_listener(listener);
+        spectrum.audio_.mute(false);
+      }
+    } ahead{*this, memory_.listener()};
+    memory_.set_listener(nullptr);
+    audio_.mute(true);
+    run_frames(frames);
+    return cycles;
+  }
+
+  // Turns rendering off for headless runs; timing and interrupts carry on regardless.
+  void rendering(const bool enable) { video_.rendering(enable); }
+
   [[nodiscard]] const auto &z80() const { return z80_; }
   [[nodiscard]] const auto &video() const { return video_; }
   [[nodiscard]] const auto &memory() const { return memory_; }
@@ -124,7 +241,106 @@ public:
   }
   void stop() { tape_.stop(); }
 
-  void trace_next(const std::size_t instructions) { trace_next_instructions_ = instructions; }
+  // Traces the next `instructions` instructions: as text on stdout, or as binary records to `sink` if one is given.
+  void trace_next(const std::size_t instructions, TraceSink *sink = nullptr) {
+    trace_next_instructions_ = instructions;
+    trace_sink_ = sink;
+  }
+
+  // Draws the screen as the beam would rather than a line at a time, so mid-line border and attribute changes show.
+  void beam_racing(const bool enable) {
+    video_.beam_racing(enable, z80_.cycle_count());
+    memory_.watch_writes(enable ? &screen_watcher_ : nullptr, screen_page_, 0, ScreenBytes);
+  }
+
+  // Holds up the CPU's accesses to contended memory while the ULA is reading the screen, as the real machine does.
+  // Only on the 48K: the video model runs the 128K with the 48K's 224 T-state lines and 312-line frame, so the 128K's
+  // own contention timings would line up with neither the screen nor the interrupt. Nor on v1, which only contends its
+  // HALTs and bulk block ops, so would run contended code at neither speed.
+  void contention(const bool enable) {
+    if (enable && variant_ == Variant::Spectrum128)
+      throw std::runtime_error("Contention is only emulated on the 48K");
+    if (enable && !Z80Impl::ContendsAccesses)
+      throw std::runtime_error("Contention isn't emulated by this Z80 implementation");
+    z80_.contention(enable ? Video::contention_table() : std::span<const std::uint8_t>{});
+  }
+
+  // Hash of registers and memory; cheap enough to call every frame.
+  [[nodiscard]] std::uint64_t state_hash() { return state_hasher_.hash(z80_.regs(), memory_); }
+
+  // Front ends should deliver input here rather than to the keyboard directly, so it can be recorded.
+  void key_down(const std::int32_t key_code) { key_event(key_code, true); }
+  void key_up(const std::int32_t key_code) { key_event(key_code, false); }
+
+  void start_recording() {
+    recording_.emplace();
+    recording_start_ = z80_.cycle_count();
+  }
+  [[nodiscard]] Movie stop_recording() { return std::exchange(recording_, std::nullopt).value_or(Movie{}); }
+  [[nodiscard]] bool recording() const { return recording_.has_value(); }
+
+  // Replays input from now on. Load the snapshot the movie was recorded against first.
+  void play_movie(Movie movie) { movie_task_.start(std::move(movie)); }
+  [[nodiscard]] bool playing_movie() const { return movie_task_.playing(); }
+
+  // All the state that decides what runs next, so a restore replays the same future; not output or register history.
+  struct Checkpoint {
+    Memory::Checkpoint memory;
+    Z80Base::Checkpoint z80;
+    Scheduler::Checkpoint scheduler;
+    Video::Checkpoint video;
+    Audio::Checkpoint audio;
+    Tape::Checkpoint tape;
+    Keyboard keyboard;
+    std::size_t tape_time{};
+    std::size_t movie_start_cycle{};
+    std::size_t movie_next_event{};
+    IdleLoopDetector idle_loop;
+    std::size_t io_count{};
+    std::size_t last_detect{};
+    std::uint8_t last_b_read{};
+    std::size_t reads_in_a_row{};
+    std::uint8_t screen_page{};
+    bool paging_disabled{};
+    std::uint64_t instructions{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const {
+    Checkpoint checkpoint;
+    this->checkpoint(checkpoint);
+    return checkpoint;
+  }
+  // Brings `into`, an older checkpoint of this Spectrum or an empty one, up to date. Memory is most of a checkpoint,
+  // and only what's been written since is copied, so this is much cheaper than taking a new one.
+  void checkpoint(Checkpoint &into) const {
+    auto memory = std::move(into.memory);
+    memory_.checkpoint(memory);
+    into = {std::move(memory), z80_.checkpoint(), scheduler_.checkpoint(), video_.checkpoint(), audio_.checkpoint(),
+        tape_.checkpoint(), keyboard_, tape_task_.last_time_, movie_task_.start_cycle, movie_task_.next_event,
+        idle_loop_, io_count_, last_detect_, last_b_read_, reads_in_a_row_, screen_page_, paging_disabled_,
+        instructions_};
+  }
+  void restore(const Checkpoint &checkpoint) {
+    memory_.restore(checkpoint.memory);
+    z80_.restore(checkpoint.z80);
+    scheduler_.restore(checkpoint.scheduler);
+    set_screen_page(checkpoint.screen_page);
+    video_.restore(checkpoint.video);
+    audio_.restore(checkpoint.audio);
+    tape_.restore(checkpoint.tape);
+    keyboard_ = checkpoint.keyboard;
+    tape_task_.last_time_ = checkpoint.tape_time;
+    movie_task_.start_cycle = checkpoint.movie_start_cycle;
+    movie_task_.next_event = checkpoint.movie_next_event;
+    idle_loop_ = checkpoint.idle_loop;
+    io_count_ = checkpoint.io_count;
+    last_detect_ = checkpoint.last_detect;
+    last_b_read_ = checkpoint.last_b_read;
+    reads_in_a_row_ = checkpoint.reads_in_a_row;
+    paging_disabled_ = checkpoint.paging_disabled;
+    instructions_ = checkpoint.instructions;
+    last_traced_instr_cycle_count_ = z80_.cycle_count();
+    current_reg_history_index_ = 0;
+  }
 
   [[nodiscard]] std::vector<RegisterFile> history() const {
     std::vector<RegisterFile> result;
@@ -138,12 +354,24 @@ public:
     return result;
   }
 
+  // Restores the AY's registers, as saved in a snapshot. The 48K has no AY to restore.
+  void load_sound_chip(const std::span<const std::uint8_t, Ay::NumRegisters> registers, const std::uint8_t selected) {
+    if (variant_ != Variant::Spectrum128)
+      return;
+    for (auto reg = 0uz; reg < registers.size(); ++reg) {
+      audio_.select_sound_chip_register(static_cast<std::uint8_t>(reg));
+      audio_.write_sound_chip(z80_.cycle_count(), registers[reg]);
+    }
+    audio_.select_sound_chip_register(selected);
+  }
+
   void reset() {
     z80_.regs().pc(0);
     if (variant_ == Variant::Spectrum128) {
       memory_.set_page_table(page_table_for(variant_));
       memory_.set_rom_flags({true, false, false, false});
-      video_.set_page(5);
+      set_screen_page(5);
+      load_sound_chip(std::array<std::uint8_t, Ay::NumRegisters>{}, 0);
     }
     paging_disabled_ = false;
   }
@@ -158,20 +386,68 @@ private:
   Z80Impl z80_;
   std::size_t trace_next_instructions_{};
   std::size_t last_traced_instr_cycle_count_{};
+  std::uint64_t instructions_{};
+  TraceSink *trace_sink_{};
+  Checkpoint run_ahead_;
+
+  [[nodiscard]] TraceRecord capture_trace() {
+    const auto time_taken = z80_.cycle_count() - last_traced_instr_cycle_count_;
+    last_traced_instr_cycle_count_ = z80_.cycle_count();
+    const auto &regs = z80_.regs();
+    const auto pc = z80_.pc();
+    TraceRecord record{};
+    record.cycles = static_cast<std::uint32_t>(time_taken);
+    record.pc = pc;
+    for (auto i = 0uz; i < record.opcode.size(); ++i)
+      record.opcode[i] = memory_.peek(static_cast<std::uint16_t>(pc + i));
+    record.af = regs.get(RegisterFile::R16::AF);
+    record.bc = regs.get(RegisterFile::R16::BC);
+    record.de = regs.get(RegisterFile::R16::DE);
+    record.hl = regs.get(RegisterFile::R16::HL);
+    record.af_ = regs.get(RegisterFile::R16::AF_);
+    record.bc_ = regs.get(RegisterFile::R16::BC_);
+    record.de_ = regs.get(RegisterFile::R16::DE_);
+    record.hl_ = regs.get(RegisterFile::R16::HL_);
+    record.ix = regs.ix();
+    record.iy = regs.iy();
+    record.sp = regs.sp();
+    record.i = regs.i();
+    record.r = regs.r();
+    return record;
+  }
   Variant variant_;
+  StateHasher state_hasher_;
 
   struct VideoTask final : Scheduler::Task {
     Spectrum &spectrum;
     explicit VideoTask(Spectrum &spectrum_) : spectrum(spectrum_) { spectrum.scheduler_.schedule(*this, 0); }
-    void run(std::size_t) override { spectrum.video_line(); }
+    void run(const std::size_t cycles) override { spectrum.video_line(cycles); }
   };
   VideoTask video_task_{*this};
-  void video_line() {
+  void video_line(const std::size_t cycles) {
+    video_.catch_up(cycles);
     if (video_.next_scan_line())
       z80_.interrupt();
     scheduler_.schedule(video_task_, Video::CyclesPerScanLine);
   }
 
+  // Pixels and attributes.
+  static constexpr std::size_t ScreenBytes = 0x1b00;
+  std::uint8_t screen_page_{1};
+  struct ScreenWatcher final : Memory::WriteWatcher {
+    Spectrum &spectrum;
+    explicit ScreenWatcher(Spectrum &spectrum_) : spectrum(spectrum_) {}
+    void before_write() override { spectrum.video_.catch_up(spectrum.z80_.cycle_count()); }
+  };
+  ScreenWatcher screen_watcher_{*this};
+  void set_screen_page(const std::uint8_t page) {
+    video_.catch_up(z80_.cycle_count());
+    video_.set_page(page);
+    screen_page_ = page;
+    if (video_.beam_racing())
+      memory_.watch_writes(&screen_watcher_, page, 0, ScreenBytes);
+  }
+
   struct TapeTask final : Scheduler::Task {
     Spectrum &spectrum;
     std::size_t last_time_{};
@@ -186,6 +462,67 @@ private:
   };
   TapeTask tape_task_{*this};
 
+  void key_event(const std::int32_t key_code, const bool pressed) {
+    if (recording_)
+      recording_->record(z80_.cycle_count() - recording_start_, key_code, pressed);
+    if (pressed)
+      keyboard_.key_down(key_code);
+    else
+      keyboard_.key_up(key_code);
+  }
+  std::optional<Movie> recording_;
+  std::size_t recording_start_{};
+
+  struct MovieTask final : Scheduler::Task {
+    Spectrum &spectrum;
+    Movie movie;
+    std::size_t start_cycle{};
+    std::size_t next_event{};
+    explicit MovieTask(Spectrum &spectrum_) : spectrum(spectrum_) {}
+    [[nodiscard]] bool playing() const { return next_event < movie.events().size(); }
+    void start(Movie movie_) {
+      // The scheduler can't cancel a task, so we can't safely restart a movie mid-flight.
+      if (playing())
+        throw std::runtime_error("A movie is already playing");
+      movie = std::move(movie_);
+      start_cycle = spectrum.z80_.cycle_count();
+      next_event = 0;
+      schedule_next();
+    }
+    void run(const std::size_t cycles) override {
+      const auto &events = movie.events();
+      for (; next_event < events.size() && start_cycle + events[next_event].cycle < cycles; ++next_event) {
+        if (const auto &event = events[next_event]; event.pressed)
+          spectrum.keyboard_.key_down(event.key_code);
+        else
+          spectrum.keyboard_.key_up(event.key_code);
+      }
+      schedule_next();
+    }
+    void schedule_next() {
+      if (!playing())
+        return;
+      // Events are recorded between instructions. Firing one cycle later lands the change in the next instruction's
+      // opcode fetch, before it can read the keyboard port, which is exactly what the recording session saw.
+      const auto fire_at = start_cycle + movie.events()[next_event].cycle + 1;
+      spectrum.scheduler_.schedule(*this, fire_at - spectrum.scheduler_.cycles());
+    }
+  };
+  MovieTask movie_task_{*this};
+
+  IdleLoopDetector idle_loop_;
+  std::size_t io_count_{};
+  void skip_idle_loop(const std::size_t end_cycles) {
+    const auto headroom = scheduler_.headroom();
+    const auto next_event =
+        headroom == std::numeric_limits<std::size_t>::max() ? headroom : z80_.cycle_count() + headroom;
+    if (const auto [cycles, refreshes] = idle_loop_.on_backward_jump(z80_, io_count_, next_event, end_cycles); cycles) {
+      const auto r = z80_.regs().r();
+      z80_.regs().r(static_cast<std::uint8_t>((r & 0x80) | ((r + refreshes) & 0x7f)));
+      z80_.pass_time(cycles);
+    }
+  }
+
   // TODO something nicer
   std::size_t last_detect_{};
   std::uint8_t last_b_read_{};
@@ -243,6 +580,14 @@ private:
       default: std::unreachable();
     }
   }
+  static constexpr std::uint64_t contended_pages_for(const Variant variant) {
+    switch (variant) {
+      case Variant::Spectrum48: return 1u << 1;
+      // The odd-numbered banks.
+      case Variant::Spectrum128: return 1u << 1 | 1u << 3 | 1u << 5 | 1u << 7;
+      default: std::unreachable();
+    }
+  }
   static constexpr std::array<std::uint8_t, 4> page_table_for(const Variant variant) {
     switch (variant) {
       case Variant::Spectrum48: return {0, 1, 2, 3};
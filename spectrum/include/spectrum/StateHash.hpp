@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include "peripherals/Memory.hpp"
+#include "z80/common/RegisterFile.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#endif
+
+namespace specbolt {
+
+// Cheap whole-machine hash used to spot divergence between Z80 implementations. Memory pages are hashed once and then
+// only rehashed when Memory reports them dirty, so hashing every frame costs little more than hashing the registers.
+// Only one StateHasher should be used per Memory, as hashing clears the dirty flags.
+SPECBOLT_EXPORT
+class StateHasher {
+public:
+  [[nodiscard]] std::uint64_t hash(const RegisterFile &regs, Memory &memory);
+
+  [[nodiscard]] static std::uint64_t hash_registers(const RegisterFile &regs);
+  [[nodiscard]] static std::uint64_t hash_bytes(std::span<const std::uint8_t> bytes);
+
+private:
+  std::vector<std::uint64_t> page_hashes_;
+};
+
+} // namespace specbolt
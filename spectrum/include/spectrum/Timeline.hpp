@@ -0,0 +1,174 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include "spectrum/Breakpoints.hpp"
+#include "spectrum/Spectrum.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+#endif
+
+namespace specbolt {
+
+// Reverse execution for a debugger. Checkpoints are taken as the program runs, and going back restores the nearest one
+// before the target and runs forward from there. Running on from a checkpoint repeats exactly what happened the first
+// time, so this arrives at the very state the machine was in. Positions are Spectrum::instructions(), so while there's
+// a timeline everything must run through the debugging paths that count them.
+//
+// Checkpoints are dense near the current position and thin out with distance from it: one is only kept if its
+// neighbours are further apart than 1/Density of its distance. Stepping back a little replays at most MinSpacing
+// instructions, going further back costs in proportion to how far, and the number kept grows only with the logarithm
+// of the session's length. Replaying lays down new checkpoints as it goes, so stepping back again stays cheap.
+SPECBOLT_EXPORT
+template<typename Z80Impl>
+class Timeline {
+public:
+  explicit Timeline(Spectrum<Z80Impl> &spectrum) : spectrum_(spectrum) {
+    // Done in bulk, a repeating instruction's count of steps would depend on whether memory has a listener, and so on
+    // whether there are watchpoints; one step per repeat keeps positions the same however the history is replayed.
+    spectrum_.z80().accelerate_block_ops(false);
+    forget();
+  }
+
+  // Starts afresh from here, e.g. after loading a snapshot, when the history no longer leads to the present.
+  void forget() {
+    checkpoints_.clear();
+    take_checkpoint();
+  }
+
+  // Call after running forwards, e.g. after each step and each frame; it takes a checkpoint only when one's due.
+  void note_progress() {
+    if (spectrum_.instructions() >= at_or_before(spectrum_.instructions()).instructions + MinSpacing)
+      take_checkpoint();
+  }
+
+  [[nodiscard]] std::uint64_t earliest() const { return checkpoints_.front().instructions; }
+  [[nodiscard]] std::size_t num_checkpoints() const { return checkpoints_.size(); }
+
+  // Goes to just after instruction `target`, or as far back as the history goes. Returns false if that wasn't far
+  // enough.
+  bool seek(const std::uint64_t target) {
+    const auto reachable = std::max(target, earliest());
+    if (reachable < spectrum_.instructions() || at_or_before(reachable).instructions > spectrum_.instructions())
+      spectrum_.restore(at_or_before(reachable));
+    run_to(reachable);
+    return reachable == target;
+  }
+
+  bool step_back(const std::uint64_t instructions) {
+    const auto now = spectrum_.instructions();
+    return seek(now > instructions ? now - instructions : 0) && now >= instructions;
+  }
+
+  // The reverse of stepping until PC changes: back to the first of the run of instructions at the same address as the
+  // last one. Returns false if there was nothing to go back to.
+  bool next_back() {
+    const auto now = spectrum_.instructions();
+    if (now <= earliest())
+      return false;
+    std::optional<std::uint16_t> pc;
+    auto run_start = now - 1;
+    for (auto end = now; end > earliest();) {
+      const auto from = at_or_before(end - 1).instructions;
+      // The PC of each state from `from` up to, but not including, `end`.
+      std::vector<std::uint16_t> pcs;
+      seek(from);
+      pcs.push_back(spectrum_.z80().pc());
+      while (spectrum_.instructions() + 1 < end) {
+        spectrum_.run_cycles(1, true);
+        pcs.push_back(spectrum_.z80().pc());
+      }
+      if (!pc)
+        pc = pcs.back();
+      for (auto index = pcs.size(); index-- > 0;) {
+        if (pcs[index] != *pc)
+          return seek(run_start);
+        run_start = from + index;
+      }
+      end = from;
+    }
+    return seek(run_start);
+  }
+
+  // Runs backwards to the most recent time one of `breakpoints` was hit, returning the hit; or, if none was, to the
+  // start of the history.
+  std::optional<Breakpoints::Hit> continue_back(Breakpoints &breakpoints) {
+    const auto now = spectrum_.instructions();
+    // Each pass looks for hits in the states after `from`, up to and including `end`.
+    for (auto end = now - 1; end > earliest() && now > earliest();) {
+      const auto from = at_or_before(end - 1).instructions;
+      seek(from);
+      std::optional<std::uint64_t> hit_at;
+      std::optional<Breakpoints::Hit> hit;
+      while (spectrum_.instructions() < end) {
+        if (spectrum_.run_until_break(breakpoints, Spectrum<Z80Impl>::cycles_per_frame, end)) {
+          hit_at = spectrum_.instructions();
+          hit = breakpoints.hit();
+        }
+      }
+      if (hit_at) {
+        seek(*hit_at);
+        return hit;
+      }
+      end = from;
+    }
+    seek(earliest());
+    return std::nullopt;
+  }
+
+private:
+  using Checkpoint = typename Spectrum<Z80Impl>::Checkpoint;
+
+  static constexpr std::uint64_t MinSpacing = 10'000;
+  static constexpr std::uint64_t Density = 8;
+
+  Spectrum<Z80Impl> &spectrum_;
+  Breakpoints no_breakpoints_;
+  // In order of instructions(), and never empty.
+  std::vector<Checkpoint> checkpoints_;
+
+  [[nodiscard]] const Checkpoint &at_or_before(const std::uint64_t instructions) const {
+    const auto after = std::ranges::upper_bound(checkpoints_, instructions, {}, &Checkpoint::instructions);
+    return after == checkpoints_.begin() ? checkpoints_.front() : *std::prev(after);
+  }
+
+  void run_to(const std::uint64_t target) {
+    while (spectrum_.instructions() < target) {
+      const auto due = std::max(at_or_before(spectrum_.instructions()).instructions + MinSpacing,
+          spectrum_.instructions() + 1);
+      spectrum_.run_until_break(no_breakpoints_, Spectrum<Z80Impl>::cycles_per_frame, std::min(target, due));
+      note_progress();
+    }
+  }
+
+  void take_checkpoint() {
+    auto checkpoint = spectrum_.checkpoint();
+    const auto position =
+        std::ranges::lower_bound(checkpoints_, checkpoint.instructions, {}, &Checkpoint::instructions);
+    if (position != checkpoints_.end() && position->instructions == checkpoint.instructions)
+      *position = std::move(checkpoint);
+    else
+      checkpoints_.insert(position, std::move(checkpoint));
+    thin();
+  }
+
+  // Drops the checkpoints that aren't needed for the spacing to grow with distance from the present. The first is
+  // always kept, as the furthest anything can go back.
+  void thin() {
+    const auto now = spectrum_.instructions();
+    for (auto index = checkpoints_.size() - 1; index-- > 1;) {
+      const auto at = checkpoints_[index].instructions;
+      const auto distance = at > now ? at - now : now - at;
+      const auto gap = checkpoints_[index + 1].instructions - checkpoints_[index - 1].instructions;
+      if (gap <= std::max(MinSpacing, distance / Density))
+        checkpoints_.erase(checkpoints_.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+  }
+};
+
+} // namespace specbolt
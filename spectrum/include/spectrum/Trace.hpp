@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include <array>
+#include <cstdint>
+#endif
+
+namespace specbolt {
+
+// One executed instruction, as captured by Spectrum::trace_next() before it runs. Records are a fixed size with no
+// padding so they can be streamed to disk as they are and read back without parsing.
+SPECBOLT_EXPORT
+struct [[gnu::packed]] TraceRecord {
+  std::uint32_t cycles; // T-states since the previous traced instruction.
+  std::uint16_t pc;
+  std::array<std::uint8_t, 4> opcode; // The bytes at pc; only as many as the instruction needs are meaningful.
+  std::uint16_t af, bc, de, hl;
+  std::uint16_t af_, bc_, de_, hl_;
+  std::uint16_t ix, iy, sp;
+  std::uint8_t i, r;
+};
+static_assert(sizeof(TraceRecord) == 34);
+
+// Where binary trace records go instead of being printed.
+SPECBOLT_EXPORT
+class TraceSink {
+public:
+  virtual ~TraceSink() = default;
+  virtual void record(const TraceRecord &record) = 0;
+};
+
+} // namespace specbolt
@@ -1,5 +1,10 @@
 export module spectrum;
 
 export import :Assets;
+export import :Breakpoints;
+export import :IdleLoop;
 export import :Spectrum;
 export import :Snapshot;
+export import :StateHash;
+export import :Timeline;
+export import :Trace;
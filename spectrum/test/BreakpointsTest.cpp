@@ -0,0 +1,178 @@
+#ifdef SPECBOLT_MODULES
+import peripherals;
+import spectrum;
+import z80_common;
+import z80_v3;
+#else
+#include "peripherals/Memory.hpp"
+#include "spectrum/Breakpoints.hpp"
+#include "z80/common/Scheduler.hpp"
+#include "z80/v3/Z80.hpp"
+#endif
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+namespace specbolt {
+
+namespace {
+
+struct Machine {
+  Scheduler scheduler;
+  Memory memory{4};
+  v3::Z80 z80{scheduler, memory};
+
+  explicit Machine(const std::initializer_list<std::uint8_t> program) {
+    memory.set_rom_flags({false, false, false, false});
+    std::uint16_t address = 0x8000;
+    for (const auto byte: program)
+      memory.write(address++, byte);
+    z80.regs().pc(0x8000);
+  }
+
+  [[nodiscard]] bool holds(const char *expression) const { return Condition(expression)(z80); }
+};
+
+// Did the last access hit a watchpoint? Checking also clears the hit for the next access.
+bool hit(Breakpoints &breakpoints, const Machine &machine) { return breakpoints.check(machine.z80); }
+
+} // namespace
+
+TEST_CASE("Conditions") {
+  Machine machine{};
+  auto &regs = machine.z80.regs();
+  regs.set(RegisterFile::R16::HL, 0x4023);
+  regs.set(RegisterFile::R8::A, 0);
+  regs.set(RegisterFile::R8::B, 7);
+
+  SECTION("bitwise operators bind tighter than comparisons") {
+    CHECK(machine.holds("hl & 0xff00 == 0x4000"));
+    CHECK(machine.holds("hl & 0xff00 | 0x23 == 0x4023"));
+    CHECK_FALSE(machine.holds("hl & 0xff00 == 0x4100"));
+  }
+  SECTION("not") {
+    CHECK(machine.holds("!a"));
+    CHECK_FALSE(machine.holds("!b"));
+    CHECK(machine.holds("!!b"));
+    CHECK(machine.holds("!(a == 1)"));
+  }
+  SECTION("not equal isn't mistaken for not") {
+    CHECK_FALSE(machine.holds("a != 0"));
+    CHECK(machine.holds("b != 0"));
+    CHECK(machine.holds("b!=0"));
+  }
+  SECTION("logical and isn't mistaken for bitwise and") {
+    CHECK_FALSE(machine.holds("a&&b"));
+    CHECK(machine.holds("b&&b"));
+    CHECK(machine.holds("b&b"));
+    CHECK(machine.holds("a||b"));
+    CHECK(machine.holds("a == 0 && b == 7 || a == 1"));
+  }
+  SECTION("arithmetic is unsigned") {
+    CHECK(machine.holds("a - 1 > b"));
+    CHECK(machine.holds("b + 1 == 8"));
+  }
+  SECTION("memory") {
+    machine.memory.write(0x4023, 0x42);
+    machine.memory.write(0x4024, 0x99);
+    CHECK(machine.holds("[hl] == 0x42"));
+    CHECK(machine.holds("[hl + 1] == 0x99"));
+    CHECK(machine.holds("[0x4023] == 66"));
+    CHECK(machine.holds("[[hl] + 0x3fe2] == 0x99"));
+  }
+  SECTION("registers") {
+    CHECK(machine.holds("pc == 0x8000"));
+    CHECK(machine.holds("HL == 0x4023 && H == 0x40"));
+  }
+  SECTION("nesting is limited") {
+    std::string expression = "1";
+    for (auto depth = 1; depth < 32; ++depth)
+      expression = "1 + (" + expression + ")";
+    CHECK(machine.holds(expression.c_str()));
+    CHECK_THROWS_AS(Condition("1 + (" + expression + ")"), std::runtime_error);
+  }
+  SECTION("syntax errors are rejected") {
+    for (const auto *bad: {"", "a ==", "(a", "[hl", "a b", "a === 1", "0x", "0x123456789", "q == 1", "hl & & 1"}) {
+      INFO(bad);
+      CHECK_THROWS_AS(Condition(bad), std::runtime_error);
+    }
+  }
+}
+
+TEST_CASE("Breakpoints") {
+  Machine machine{};
+  Breakpoints breakpoints;
+
+  SECTION("stop at a PC") {
+    breakpoints.add_breakpoint(0x8000);
+    CHECK(hit(breakpoints, machine));
+    CHECK(breakpoints.hit()->kind == Breakpoints::Hit::Kind::Breakpoint);
+    breakpoints.remove_breakpoint(0x8000);
+    CHECK_FALSE(hit(breakpoints, machine));
+  }
+  SECTION("only when the condition holds") {
+    breakpoints.add_breakpoint(0x8000, Condition("a == 1"));
+    CHECK_FALSE(hit(breakpoints, machine));
+    machine.z80.regs().set(RegisterFile::R8::A, 1);
+    CHECK(hit(breakpoints, machine));
+  }
+}
+
+TEST_CASE("Watchpoints") {
+  Machine machine{};
+  Breakpoints breakpoints;
+  const auto write_hits = [&](const std::uint16_t address) {
+    breakpoints.on_memory_write(address);
+    return hit(breakpoints, machine) && breakpoints.hit()->kind == Breakpoints::Hit::Kind::Write &&
+           breakpoints.hit()->address == address;
+  };
+
+  SECTION("a range spanning two 1K pages") {
+    breakpoints.watch_writes(0x43fe, 4);
+    CHECK(breakpoints.has_watchpoints());
+    CHECK_FALSE(write_hits(0x43fd));
+    CHECK(write_hits(0x43fe));
+    CHECK(write_hits(0x4401));
+    CHECK_FALSE(write_hits(0x4402));
+    SECTION("unwatching the first page leaves the second") {
+      breakpoints.unwatch_writes(0x43fe, 2);
+      CHECK_FALSE(write_hits(0x43ff));
+      CHECK(write_hits(0x4400));
+      breakpoints.unwatch_writes(0x4400, 2);
+      CHECK_FALSE(write_hits(0x4400));
+      CHECK_FALSE(breakpoints.has_watchpoints());
+    }
+    SECTION("a page stays watched while another range in it is") {
+      breakpoints.watch_writes(0x4410);
+      breakpoints.unwatch_writes(0x43fe, 4);
+      CHECK(breakpoints.has_watchpoints());
+      CHECK_FALSE(write_hits(0x4401));
+      CHECK(write_hits(0x4410));
+    }
+    SECTION("reads are watched separately") {
+      breakpoints.on_memory_read(0x43fe);
+      CHECK_FALSE(hit(breakpoints, machine));
+    }
+  }
+  SECTION("a range wrapping around the top of memory") {
+    breakpoints.watch_reads(0xffff, 2);
+    breakpoints.on_memory_read(0x0000);
+    CHECK(hit(breakpoints, machine));
+    breakpoints.unwatch_reads(0xffff, 2);
+    CHECK_FALSE(breakpoints.has_watchpoints());
+  }
+}
+
+TEST_CASE("Conditions see the flags of the last instruction") {
+  // ld a, 0x10; sub a. With lazy flags the sub only records its operands, so F in Z80Base is still the old value.
+  Machine machine{0x3e, 0x10, 0x97};
+  machine.z80.execute_one();
+  machine.z80.execute_one();
+  CHECK(Condition("f == 0x42")(machine.z80));
+  CHECK(Condition("af == 0x0042")(machine.z80));
+}
+
+} // namespace specbolt
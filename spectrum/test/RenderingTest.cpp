@@ -0,0 +1,36 @@
+#ifdef SPECBOLT_MODULES
+import spectrum;
+import z80_v1;
+import z80_v2;
+#else
+#include "spectrum/Assets.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "z80/v1/Z80.hpp"
+#include "z80/v2/Z80.hpp"
+#endif
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace specbolt {
+
+TEMPLATE_TEST_CASE("Frames run without rendering leave the machine as rendered ones do", "[Rendering]", v1::Z80,
+    v2::Z80) {
+  for (const bool beam_racing: {false, true}) {
+    Spectrum<TestType> rendered(Variant::Spectrum48, get_asset_dir() / "48.rom", 44'100);
+    Spectrum<TestType> skipped(Variant::Spectrum48, get_asset_dir() / "48.rom", 44'100);
+    rendered.beam_racing(beam_racing);
+    skipped.beam_racing(beam_racing);
+    skipped.rendering(false);
+    // Through the boot, which clears the screen and waits on interrupts, and into the keyboard scan.
+    for (auto frame = 0; frame < 150; ++frame) {
+      INFO("beam racing " << beam_racing << " frame " << frame);
+      CHECK(rendered.run_frame() == skipped.run_frame());
+      REQUIRE(rendered.z80().cycle_count() == skipped.z80().cycle_count());
+      REQUIRE(rendered.z80().regs() == skipped.z80().regs());
+      REQUIRE(rendered.state_hash() == skipped.state_hash());
+    }
+  }
+}
+
+} // namespace specbolt
@@ -0,0 +1,44 @@
+#ifdef SPECBOLT_MODULES
+import spectrum;
+import z80_v1;
+import z80_v2;
+#else
+#include "spectrum/Assets.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "z80/v1/Z80.hpp"
+#include "z80/v2/Z80.hpp"
+#endif
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace specbolt {
+
+TEMPLATE_TEST_CASE("Running ahead leaves the machine as a plain frame would", "[RunAhead]", v1::Z80, v2::Z80) {
+  for (const auto variant: {Variant::Spectrum48, Variant::Spectrum128}) {
+    const auto rom = get_asset_dir() / (variant == Variant::Spectrum128 ? "128.rom" : "48.rom");
+    Spectrum<TestType> plain(variant, rom, 44'100);
+    Spectrum<TestType> ahead(variant, rom, 44'100);
+    // Through the boot, and then a keypress, which clicks, while the frames ahead see it held down.
+    for (auto frame = 0; frame < 150; ++frame) {
+      INFO(static_cast<int>(variant) << " frame " << frame);
+      if (frame == 120 || frame == 125) {
+        for (auto *spectrum: {&plain, &ahead}) {
+          if (frame == 120)
+            spectrum->key_down('a');
+          else
+            spectrum->key_up('a');
+        }
+      }
+      CHECK(plain.run_frame() == ahead.run_frame_ahead(2));
+      REQUIRE(plain.z80().cycle_count() == ahead.z80().cycle_count());
+      REQUIRE(plain.state_hash() == ahead.state_hash());
+      CHECK(plain.audio().checkpoint().registers == ahead.audio().checkpoint().registers);
+      CHECK(plain.audio().checkpoint().selected == ahead.audio().checkpoint().selected);
+      CHECK(plain.audio().end_frame(plain.z80().cycle_count()) ==
+            ahead.audio().end_frame(ahead.z80().cycle_count()));
+    }
+  }
+}
+
+} // namespace specbolt
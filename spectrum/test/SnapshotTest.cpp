@@ -0,0 +1,66 @@
+#ifdef SPECBOLT_MODULES
+import peripherals;
+import spectrum;
+import z80_common;
+import z80_v3;
+#else
+#include "peripherals/Memory.hpp"
+#include "spectrum/Snapshot.hpp"
+#include "z80/common/Scheduler.hpp"
+#include "z80/v3/Z80.hpp"
+#endif
+
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace specbolt {
+
+TEST_CASE("Loading a snapshot replaces flags the core had yet to work out") {
+  Scheduler scheduler;
+  Memory memory{4};
+  memory.set_rom_flags({false, false, false, false});
+  v3::Z80 z80{scheduler, memory};
+  // ld a, 0x10; sub a: with lazy flags, Z set and carry clear are still pending.
+  memory.write(0x8000, 0x3e);
+  memory.write(0x8001, 0x10);
+  memory.write(0x8002, 0x97);
+  z80.regs().pc(0x8000);
+  z80.execute_one();
+  z80.execute_one();
+
+  // A .sna with only carry set in F, returning to a `jr c` at 0x9000.
+  std::array<std::uint8_t, 27> header{};
+  header[0x15] = 0x01; // F
+  header[0x16] = 0xff; // A
+  header[0x17] = 0x00; // SP low
+  header[0x18] = 0xa0; // SP high
+  std::vector<std::uint8_t> ram(48 * 1024);
+  ram[0xa000 - 0x4000] = 0x00;
+  ram[0xa001 - 0x4000] = 0x90;
+  ram[0x9000 - 0x4000] = 0x38;
+  ram[0x9001 - 0x4000] = 0x10;
+  std::random_device random;
+  const auto path = std::filesystem::temp_directory_path() /
+                    std::format("specbolt_snapshot_test_{:08x}{:08x}.sna", random(), random());
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file.write(reinterpret_cast<const char *>(ram.data()), static_cast<std::streamsize>(ram.size()));
+  }
+  Snapshot::load(path, z80);
+  std::filesystem::remove(path);
+
+  CHECK(z80.regs().pc() == 0x9000);
+  CHECK(z80.regs().get(RegisterFile::R8::F) == 0x01);
+  CHECK(z80.flags().carry());
+  z80.execute_one();
+  CHECK(z80.regs().pc() == 0x9012);
+}
+
+} // namespace specbolt
@@ -0,0 +1,109 @@
+#ifdef SPECBOLT_MODULES
+import spectrum;
+import z80_common;
+import z80_v2;
+import z80_v3;
+#else
+#include "spectrum/Assets.hpp"
+#include "spectrum/Spectrum.hpp"
+#include "spectrum/Timeline.hpp"
+#include "z80/common/RegisterFile.hpp"
+#include "z80/v2/Z80.hpp"
+#include "z80/v3/Z80.hpp"
+#endif
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace specbolt {
+
+TEMPLATE_TEST_CASE("Going back in time arrives at the state the machine was in", "[Timeline]", v2::Z80, v3::Z80) {
+  Spectrum<TestType> spectrum(Variant::Spectrum48, get_asset_dir() / "48.rom", 44'100);
+  // Past the memory check, so the history takes in interrupts and the keyboard scan.
+  for (auto frame = 0; frame < 100; ++frame)
+    spectrum.run_frame();
+  Timeline<TestType> timeline(spectrum);
+
+  // The state after each instruction, and a hash of the whole machine after every HashEvery.
+  struct State {
+    RegisterFile regs;
+    std::size_t cycles{};
+  };
+  constexpr std::uint64_t Instructions = 100'000;
+  constexpr std::uint64_t HashEvery = 2'500;
+  const auto start = spectrum.instructions();
+  std::vector<State> states;
+  std::vector<std::uint64_t> hashes;
+  const auto record = [&] {
+    if (states.size() % HashEvery == 0)
+      hashes.push_back(spectrum.state_hash());
+    states.push_back({spectrum.z80().regs(), spectrum.z80().cycle_count()});
+  };
+  while (spectrum.instructions() < start + Instructions) {
+    record();
+    spectrum.run_cycles(1, true);
+    timeline.note_progress();
+  }
+  record();
+
+  const auto at = [&](const std::uint64_t position) {
+    const auto &[regs, cycles] = states[position];
+    return spectrum.instructions() == start + position && spectrum.z80().regs() == regs &&
+           spectrum.z80().cycle_count() == cycles;
+  };
+  const auto hash_matches = [&](const std::uint64_t position) {
+    return spectrum.state_hash() == hashes[position / HashEvery];
+  };
+
+  SECTION("stepping back") {
+    REQUIRE(timeline.step_back(1));
+    CHECK(at(Instructions - 1));
+    REQUIRE(timeline.step_back(HashEvery - 1));
+    CHECK(at(Instructions - HashEvery));
+    CHECK(hash_matches(Instructions - HashEvery));
+  }
+
+  SECTION("seeking back and forth") {
+    for (auto position = Instructions; position > 0; position -= HashEvery) {
+      REQUIRE(timeline.seek(start + position - HashEvery));
+      CHECK(at(position - HashEvery));
+      CHECK(hash_matches(position - HashEvery));
+    }
+    for (auto position = HashEvery / 2; position < Instructions; position += HashEvery * 3) {
+      REQUIRE(timeline.seek(start + position));
+      CHECK(at(position));
+    }
+  }
+
+  SECTION("reverse next") {
+    auto position = Instructions;
+    for (auto step = 0; step < 50; ++step) {
+      // Back to the first of the run of states before this one that share its predecessor's PC.
+      const auto pc = states[position - 1].regs.pc();
+      auto expected = position - 1;
+      while (expected > 0 && states[expected - 1].regs.pc() == pc)
+        --expected;
+      REQUIRE(timeline.next_back());
+      CHECK(at(expected));
+      position = expected;
+    }
+  }
+
+  SECTION("replaying from the start") {
+    REQUIRE(timeline.seek(start));
+    CHECK(hash_matches(0));
+    std::size_t mismatches{};
+    for (auto position = 1uz; position <= Instructions; ++position) {
+      spectrum.run_cycles(1, true);
+      timeline.note_progress();
+      if (!at(position) || (position % HashEvery == 0 && !hash_matches(position)))
+        ++mismatches;
+    }
+    CHECK(mismatches == 0);
+  }
+}
+
+} // namespace specbolt
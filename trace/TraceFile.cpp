@@ -0,0 +1,109 @@
+#include "TraceFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace specbolt {
+
+namespace {
+
+constexpr std::array<char, 4> Magic{'S', 'B', 'T', 'R'};
+constexpr std::uint8_t Version = 1;
+constexpr std::uint8_t RecordSize = sizeof(TraceRecord);
+
+} // namespace
+
+TraceFileWriter::TraceFileWriter(const std::filesystem::path &path) : path_(path), output_(path, std::ios::binary) {
+  if (!output_) {
+    throw std::runtime_error(std::format("Failed to open file '{}': {}", path.string(), std::strerror(errno)));
+  }
+  output_.write(Magic.data(), Magic.size());
+  output_.put(static_cast<char>(Version));
+  output_.put(static_cast<char>(RecordSize));
+  filling_.reserve(RecordsPerBuffer);
+  writing_.reserve(RecordsPerBuffer);
+  writer_ = std::thread([this] { write_loop(); });
+}
+
+TraceFileWriter::~TraceFileWriter() {
+  try {
+    flush();
+  }
+  catch (...) {
+    // Nowhere to report it from a destructor; callers wanting to know use flush().
+  }
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  writer_.join();
+}
+
+void TraceFileWriter::hand_over() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !pending_; });
+  std::swap(filling_, writing_);
+  pending_ = true;
+  lock.unlock();
+  cv_.notify_all();
+  filling_.clear();
+}
+
+void TraceFileWriter::flush() {
+  if (!filling_.empty())
+    hand_over();
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !pending_; });
+  output_.flush();
+  if (failed_ || !output_)
+    throw std::runtime_error(std::format("Unable to write file '{}'", path_.string()));
+}
+
+void TraceFileWriter::write_loop() {
+  std::unique_lock lock(mutex_);
+  for (;;) {
+    cv_.wait(lock, [this] { return pending_ || stopping_; });
+    if (!pending_)
+      return;
+    // The emulator only touches writing_ by swapping it, which waits for pending_ to clear.
+    lock.unlock();
+    output_.write(reinterpret_cast<const char *>(writing_.data()),
+        static_cast<std::streamsize>(writing_.size() * sizeof(TraceRecord)));
+    const bool failed = !output_;
+    lock.lock();
+    failed_ |= failed;
+    pending_ = false;
+    cv_.notify_all();
+  }
+}
+
+TraceFileReader::TraceFileReader(const std::filesystem::path &path) : path_(path), input_(path, std::ios::binary) {
+  if (!input_) {
+    throw std::runtime_error(std::format("Failed to open file '{}': {}", path.string(), std::strerror(errno)));
+  }
+  std::array<char, Magic.size() + 2> header{};
+  input_.read(header.data(), header.size());
+  if (!input_ || !std::equal(Magic.begin(), Magic.end(), header.begin()))
+    throw std::runtime_error(std::format("'{}' is not a trace file", path.string()));
+  if (const auto version = static_cast<std::uint8_t>(header[Magic.size()]); version != Version)
+    throw std::runtime_error(std::format("Unsupported trace version {}", version));
+  if (const auto size = static_cast<std::uint8_t>(header[Magic.size() + 1]); size != RecordSize)
+    throw std::runtime_error(std::format("Unexpected trace record size {}", size));
+}
+
+std::optional<TraceRecord> TraceFileReader::next() {
+  TraceRecord record{};
+  input_.read(reinterpret_cast<char *>(&record), sizeof(record));
+  if (input_.gcount() == 0 && input_.eof())
+    return std::nullopt;
+  if (!input_)
+    throw std::runtime_error(std::format("Truncated trace file '{}'", path_.string()));
+  return record;
+}
+
+} // namespace specbolt
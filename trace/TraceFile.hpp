@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#ifndef SPECBOLT_MODULES
+#include "spectrum/Trace.hpp"
+#else
+import spectrum;
+#endif
+
+namespace specbolt {
+
+// Binary trace files are a short header (magic, version and record size) followed by raw TraceRecords until the end of
+// the file.
+
+// Streams trace records to a file. Records are gathered into large buffers, and a background thread writes each full
+// buffer while the emulator fills the next, so tracing costs little more than a copy per instruction.
+class TraceFileWriter final : public TraceSink {
+public:
+  explicit TraceFileWriter(const std::filesystem::path &path);
+  ~TraceFileWriter() override;
+
+  TraceFileWriter(const TraceFileWriter &) = delete;
+  TraceFileWriter &operator=(const TraceFileWriter &) = delete;
+
+  void record(const TraceRecord &record) override {
+    filling_.push_back(record);
+    if (filling_.size() == RecordsPerBuffer) [[unlikely]]
+      hand_over();
+  }
+
+  // Writes out everything recorded so far, throwing if any write failed.
+  void flush();
+
+private:
+  static constexpr std::size_t RecordsPerBuffer = 64 * 1024;
+
+  std::filesystem::path path_;
+  std::ofstream output_;
+  std::vector<TraceRecord> filling_;
+  std::vector<TraceRecord> writing_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool pending_{};
+  bool stopping_{};
+  bool failed_{};
+  std::thread writer_;
+
+  void hand_over();
+  void write_loop();
+};
+
+// Reads trace records back one at a time, so traces larger than memory can be decoded.
+class TraceFileReader {
+public:
+  explicit TraceFileReader(const std::filesystem::path &path);
+
+  [[nodiscard]] std::optional<TraceRecord> next();
+
+private:
+  std::filesystem::path path_;
+  std::ifstream input_;
+};
+
+} // namespace specbolt
@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <print>
+#include <stdexcept>
+
+#include <lyra/lyra.hpp>
+
+#include "TraceFile.hpp"
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+import z80_common;
+import z80_v1;
+#else
+#include "peripherals/Memory.hpp"
+#include "z80/common/Flags.hpp"
+#include "z80/v1/Disassembler.hpp"
+#endif
+
+// Decodes a binary trace written by Spectrum::trace_next() into the same text the emulator prints when tracing to
+// stdout, optionally followed by the disassembly of each instruction.
+int main(const int argc, const char *argv[]) try {
+  std::filesystem::path trace;
+  bool plain{};
+  bool need_help{};
+  const auto cli = lyra::cli() //
+                   | lyra::help(need_help) //
+                   | lyra::opt(plain)["--plain"]("Leave out the disassembly") //
+                   | lyra::arg(trace, "TRACE")("Binary trace file to decode").required();
+  if (const auto parse_result = cli.parse({argc, argv}); !parse_result) {
+    std::println(std::cerr, "Error in command line: {}", parse_result.message());
+    return 1;
+  }
+  if (need_help) {
+    std::cout << cli << '\n';
+    return 0;
+  }
+
+  // The disassembler reads from memory, so each instruction's bytes are dropped into a scratch copy at its address.
+  specbolt::Memory memory{4};
+  memory.set_rom_flags({false, false, false, false});
+  const specbolt::v1::Disassembler dis{memory};
+
+  static constexpr auto UndocMask =
+      static_cast<std::uint16_t>(0xff00 | ~(specbolt::Flags::Flag3() | specbolt::Flags::Flag5()).to_u8());
+  specbolt::TraceFileReader reader(trace);
+  while (const auto record = reader.next()) {
+    std::print(std::cout, "{:02} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x} {:04x}", record->cycles, record->pc,
+        record->af & UndocMask, record->bc, record->de, record->hl, record->ix, record->iy, record->sp);
+    if (!plain) {
+      for (auto i = 0uz; i < record->opcode.size(); ++i)
+        memory.raw_write(static_cast<std::uint16_t>(record->pc + i), record->opcode[i]);
+      std::print(std::cout, "  {}", dis.disassemble(record->pc).to_string());
+    }
+    std::cout << '\n';
+  }
+  return 0;
+}
+catch (const std::exception &e) {
+  std::cerr << "Exception: " << e.what() << "\n";
+  return 1;
+}
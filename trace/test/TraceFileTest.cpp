@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include "TraceFile.hpp"
+
+namespace specbolt {
+
+namespace {
+
+TraceRecord make_record(const std::uint32_t index) {
+  TraceRecord record{};
+  record.cycles = index % 23;
+  record.pc = static_cast<std::uint16_t>(index * 3);
+  record.opcode = {static_cast<std::uint8_t>(index), 0xed, 0xb0, 0x00};
+  record.hl = static_cast<std::uint16_t>(index >> 16);
+  record.sp = 0xfffe;
+  record.r = static_cast<std::uint8_t>(index & 0x7f);
+  return record;
+}
+
+bool same(const TraceRecord &lhs, const TraceRecord &rhs) {
+  return lhs.cycles == rhs.cycles && lhs.pc == rhs.pc && lhs.opcode == rhs.opcode && lhs.hl == rhs.hl &&
+         lhs.sp == rhs.sp && lhs.r == rhs.r;
+}
+
+} // namespace
+
+TEST_CASE("trace file tests", "[TraceFile]") {
+  // A fresh name each run, so runs side by side don't trip over each other's files.
+  std::random_device random;
+  const auto path = std::filesystem::temp_directory_path() /
+                    std::format("specbolt_trace_file_test_{:08x}{:08x}.sbtr", random(), random());
+
+  SECTION("round trips records across several buffers") {
+    constexpr std::uint32_t count = 200'000;
+    {
+      TraceFileWriter writer(path);
+      for (auto i = 0u; i < count; ++i)
+        writer.record(make_record(i));
+    }
+    TraceFileReader reader(path);
+    std::uint32_t read{};
+    bool all_same = true;
+    while (const auto record = reader.next())
+      all_same &= same(*record, make_record(read++));
+    CHECK(read == count);
+    CHECK(all_same);
+  }
+
+  SECTION("rejects other files") {
+    std::ofstream(path) << "not a trace";
+    CHECK_THROWS_AS(TraceFileReader(path), std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+
+} // namespace specbolt
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// A single-producer, single-consumer ring of samples in the module's memory. With shared memory the emulator's worker
+// writes it and the audio worklet reads it in place. The indices run freely and wrap; their difference is the number
+// of samples waiting. The worklet only ever stores the read index, with Atomics.store, and the writer only the write
+// index, so neither needs a lock.
+class AudioRing {
+public:
+  static constexpr std::size_t Capacity = 8192; // About 170ms at 48kHz.
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  // Adds as many of `samples` as fit, dropping the rest, and returns how many are now waiting.
+  std::size_t push(const std::span<const std::int16_t> samples) {
+    const auto write = indices_[Write].load(std::memory_order_relaxed);
+    const auto waiting = write - indices_[Read].load(std::memory_order_acquire);
+    const auto count = std::min<std::size_t>(samples.size(), Capacity - waiting);
+    for (std::size_t index = 0; index < count; ++index)
+      samples_[(write + index) & (Capacity - 1)] = samples[index];
+    indices_[Write].store(static_cast<std::uint32_t>(write + count), std::memory_order_release);
+    return waiting + count;
+  }
+
+  // The worklet's side, as native code would do it: takes up to `into.size()` samples and returns how many it took.
+  std::size_t pop(const std::span<std::int16_t> into) {
+    const auto read = indices_[Read].load(std::memory_order_relaxed);
+    const auto count = std::min<std::size_t>(into.size(), indices_[Write].load(std::memory_order_acquire) - read);
+    for (std::size_t index = 0; index < count; ++index)
+      into[index] = samples_[(read + index) & (Capacity - 1)];
+    indices_[Read].store(static_cast<std::uint32_t>(read + count), std::memory_order_release);
+    return count;
+  }
+
+  [[nodiscard]] std::size_t waiting() const {
+    return indices_[Write].load(std::memory_order_relaxed) - indices_[Read].load(std::memory_order_acquire);
+  }
+
+  // For the worklet: the write then read index, as a pair of 32-bit words, and the samples.
+  [[nodiscard]] const void *indices() const { return indices_.data(); }
+  [[nodiscard]] const std::int16_t *samples() const { return samples_.data(); }
+
+private:
+  static constexpr std::size_t Write = 0;
+  static constexpr std::size_t Read = 1;
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+  std::array<std::atomic<std::uint32_t>, 2> indices_{};
+  std::array<std::int16_t, Capacity> samples_{};
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// The two buffers the worker draws frames into by turns, so that with shared memory the page can copy out one while the
+// next is drawn. Each has a flag that's set while the page has yet to finish with it: the worker sets it as it sends
+// the frame, and the page clears it, with Atomics.store, once it has copied the frame out or has a newer one instead.
+// The worker never draws into a flagged buffer, so if the page holds both the picture is skipped; the frame still runs.
+class FrameBuffers {
+public:
+  explicit FrameBuffers(const std::size_t pixels) {
+    for (auto &buffer: buffers_)
+      buffer.resize(pixels);
+  }
+
+  // For the worker: a buffer the page has finished with, or nothing if it has both. The older one is preferred, as the
+  // page may still be copying out the newer.
+  [[nodiscard]] std::span<std::uint32_t> next() {
+    for (const auto index: {newest_ ^ 1, newest_}) {
+      if (!pending_[index].load(std::memory_order_acquire)) {
+        drawing_ = index;
+        return buffers_[index];
+      }
+    }
+    return {};
+  }
+
+  // Hands the buffer from next() to the page, returning its index.
+  std::size_t publish() {
+    pending_[drawing_].store(1, std::memory_order_release);
+    newest_ = drawing_;
+    return drawing_;
+  }
+
+  // What the page does when it's done with a buffer; the worker does it too when it sends a copy instead.
+  void consumed(const std::size_t index) { pending_[index].store(0, std::memory_order_release); }
+
+  [[nodiscard]] const std::uint32_t *buffer(const std::size_t index) const { return buffers_[index].data(); }
+  // For the page: the two flags, as 32-bit words.
+  [[nodiscard]] const void *flags() const { return pending_.data(); }
+
+private:
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+  std::array<std::vector<std::uint32_t>, 2> buffers_;
+  std::array<std::atomic<std::uint32_t>, 2> pending_{};
+  std::size_t newest_{1};
+  std::size_t drawing_{};
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+
+// Decides when the worker runs the next frame. By the wall clock, that's every 20ms, with frames that were missed run
+// back to back to catch up, though never more than a second's worth. With the audio ring, it's whenever the worklet
+// has used up all but `target_samples`, so the audio hardware's clock paces the emulator. If the worklet stops reading
+// for StallMs, e.g. while the browser has audio suspended, the wall clock takes over again.
+class FramePacer {
+public:
+  static constexpr double MsPerFrame = 1000.0 / 50;
+  static constexpr double MaxMsBehind = 1000;
+  static constexpr double StallMs = 100;
+
+  explicit FramePacer(const std::size_t target_samples) : target_samples_(target_samples) {}
+
+  // After a pause, so the next frame is due straight away rather than all the ones missed meanwhile.
+  void restart() { next_frame_ms_.reset(); }
+
+  // `ring_waiting` is how many samples are waiting in the ring, if there is one.
+  [[nodiscard]] bool due(const double now_ms, const std::optional<std::size_t> ring_waiting) {
+    if (!next_frame_ms_)
+      next_frame_ms_ = now_ms;
+    if (ring_waiting) {
+      if (*ring_waiting < ring_waiting_)
+        last_read_ms_ = now_ms;
+      ring_waiting_ = *ring_waiting;
+      if (now_ms - last_read_ms_ < StallMs)
+        return *ring_waiting < target_samples_;
+    }
+    return now_ms >= *next_frame_ms_;
+  }
+
+  // Once a due frame has run and its audio has gone into the ring, if there is one. `now_ms` is the time it was due.
+  void ran(const double now_ms, const std::optional<std::size_t> ring_waiting) {
+    if (ring_waiting)
+      ring_waiting_ = *ring_waiting;
+    next_frame_ms_ = std::max(now_ms - MaxMsBehind, next_frame_ms_.value_or(now_ms) + MsPerFrame);
+  }
+
+private:
+  std::size_t target_samples_;
+  std::optional<double> next_frame_ms_;
+  std::size_t ring_waiting_{};
+  double last_read_ms_{-std::numeric_limits<double>::infinity()};
+};
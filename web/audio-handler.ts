@@ -55,9 +55,13 @@ export class AudioHandler {
         console.log("Audio initialised")
     }
 
-    postAudio(buffer: Int16Array) {
-        if (this._jsAudioNode)
-            this._jsAudioNode.port.postMessage({time: Date.now(), buffer});
+    // A port on which audio can be sent straight to the worklet, e.g. from a worker; undefined if there's no audio.
+    createAudioPort(): MessagePort | undefined {
+        if (!this._jsAudioNode)
+            return undefined;
+        const channel = new MessageChannel();
+        this._jsAudioNode.port.postMessage({port: channel.port1}, [channel.port1]);
+        return channel.port2;
     }
 
     async tryResume() {
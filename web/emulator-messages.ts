@@ -0,0 +1,20 @@
+// What the page and the emulator worker say to each other.
+
+export const SampleRate = 48000;
+
+export type EmulatorRequest =
+    | { type: "init", model: number, audioPort?: MessagePort }
+    | { type: "start" }
+    | { type: "stop" }
+    | { type: "key", code: number, pressed: boolean }
+    | { type: "load_snapshot", name: string, data: ArrayBuffer }
+    | { type: "load_tape", name: string, data: ArrayBuffer }
+    | { type: "run_frames", count: number };
+
+export type EmulatorReply =
+    // Answers init. The memory is only sent when it's shared, in which case frames are offsets into it, and the page
+    // clears a frame buffer's flag at frameFlags once it's done with it.
+    | { type: "ready", width: number, height: number, memory?: WebAssembly.Memory, frameFlags?: number }
+    | { type: "frame", video: number | Uint8ClampedArray, buffer: number, effectiveMhz: number }
+    // Acknowledges a load or run_frames, in the order they were sent.
+    | { type: "done" };
@@ -0,0 +1,104 @@
+// Runs the emulator off the page's thread. Each frame's picture goes to the page, either as an offset into the shared
+// memory of the threaded build or as a copy, and its audio goes straight to the audio worklet: through a ring in the
+// shared memory, or else as a copy over a port.
+import {EmulatorReply, EmulatorRequest} from "./emulator-messages";
+import {initialiseWasm, WasmSpectrum, WasmThreads} from "./wasm-spectrum";
+
+let wasm: WasmSpectrum;
+let audioPort: MessagePort | undefined;
+let useRing = false;
+let running = false;
+
+function reply(message: EmulatorReply, transfer: Transferable[] = []) {
+    postMessage(message, {transfer});
+}
+
+// Runs a frame and sends the page its picture.
+function emulateFrame() {
+    const ts = performance.now();
+    const numCycles = wasm.run_frame();
+    const effectiveMhz = numCycles / (performance.now() - ts) / 1000;
+    const video = wasm.render_video();
+    // The page is still holding both frame buffers, so it's behind anyway; it'll have this picture's successor.
+    if (video === undefined)
+        return;
+    if (WasmThreads) {
+        reply({type: "frame", video: video.pixels.byteOffset, buffer: video.index, effectiveMhz});
+    } else {
+        const copy = video.pixels.slice();
+        wasm.video_frame_consumed(video.index);
+        reply({type: "frame", video: copy, buffer: video.index, effectiveMhz}, [copy.buffer]);
+    }
+}
+
+function sendAudio() {
+    if (useRing) {
+        wasm.push_audio();
+    } else {
+        const audio = wasm.render_audio().slice();
+        audioPort?.postMessage({time: Date.now(), buffer: audio}, [audio.buffer]);
+    }
+}
+
+function emulate() {
+    if (!running)
+        return;
+    // When to run a frame, whether by the wall clock or the audio ring, is up to the module's FramePacer.
+    const ts = performance.now();
+    if (wasm.frame_due(ts)) {
+        emulateFrame();
+        sendAudio();
+        wasm.frame_ran(ts);
+    }
+    setTimeout(emulate, 0);
+}
+
+onmessage = async (event: MessageEvent<EmulatorRequest>) => {
+    const request = event.data;
+    switch (request.type) {
+        case "init": {
+            const {instance, data} = await initialiseWasm();
+            wasm = new WasmSpectrum(instance.exports, request.model, data);
+            audioPort = request.audioPort;
+            useRing = WasmThreads && audioPort !== undefined;
+            wasm.use_audio_ring(useRing);
+            if (useRing)
+                audioPort.postMessage({ring: wasm.audio_ring()});
+            reply({
+                type: "ready",
+                width: wasm.width,
+                height: wasm.height,
+                memory: WasmThreads ? wasm.memory : undefined,
+                frameFlags: WasmThreads ? wasm.video_frame_flags() : undefined,
+            });
+            break;
+        }
+        case "start":
+            if (!running) {
+                running = true;
+                wasm.restart_pacing();
+                setTimeout(emulate, 0);
+            }
+            break;
+        case "stop":
+            running = false;
+            break;
+        case "key":
+            wasm.key_state(request.code, request.pressed);
+            break;
+        case "load_snapshot":
+            wasm.load_snapshot(request.name, request.data);
+            emulateFrame();
+            reply({type: "done"});
+            break;
+        case "load_tape":
+            wasm.load_tape(request.name, request.data);
+            reply({type: "done"});
+            break;
+        case "run_frames":
+            for (let i = 0; i < request.count; ++i)
+                emulateFrame();
+            reply({type: "done"});
+            break;
+    }
+};
@@ -12,8 +12,10 @@ class FifoAudio extends AudioWorkletProcessor {
         this.underruns = 0;
         this.targetLatencyMs = 1000 * (1 / 50);
         this.maxQueueSizeBytes = sampleRate * 0.25;
-        this.port.onmessage = (event) => { this.onBuffer(event.data.time, event.data.buffer); };
+        this.port.onmessage = (event) => { this.onMessage(event.data); };
         this.nextLog = 0;
+        this.ringIndices = null;
+        this.ringSamples = null;
     }
 
     _queueAge() {
@@ -23,6 +25,39 @@ class FifoAudio extends AudioWorkletProcessor {
         return Date.now() - timeInBufferMs;
     }
 
+    onMessage(data) {
+        // The page may hand over a port on which the emulator's worker sends audio directly, and with shared memory the
+        // worker may then point us at a ring of samples to read in place.
+        if (data.port)
+            data.port.onmessage = (event) => { this.onMessage(event.data); };
+        else if (data.ring)
+            this.attachRing(data.ring);
+        else
+            this.onBuffer(data.time, data.buffer);
+    }
+
+    attachRing({buffer, indices, samples, capacity}) {
+        // The write then read index; we only ever store the read one.
+        this.ringIndices = new Uint32Array(buffer, indices, 2);
+        this.ringSamples = new Int16Array(buffer, samples, capacity);
+    }
+
+    _readRing(channel) {
+        const write = Atomics.load(this.ringIndices, 0);
+        let read = Atomics.load(this.ringIndices, 1);
+        const mask = this.ringSamples.length - 1;
+        for (let i = 0; i < channel.length; i++) {
+            if (read !== write) {
+                this._lastSample = this.ringSamples[read & mask] / 32768;
+                read = (read + 1) >>> 0;
+            } else {
+                this.underruns++;
+            }
+            channel[i] = this._lastSample;
+        }
+        Atomics.store(this.ringIndices, 1, read);
+    }
+
     onBuffer(time, buffer) {
         this.queue.push({offset : 0, time, buffer});
         this._queueSizeBytes += buffer.length;
@@ -62,6 +97,10 @@ class FifoAudio extends AudioWorkletProcessor {
         }
 
         const channel = outputs[0][0];
+        if (this.ringIndices) {
+            this._readRing(channel);
+            return true;
+        }
         for (let i = 0; i < channel.length; i++) {
             channel[i] = this.nextSample();
         }
@@ -1,3 +1,6 @@
+#include "AudioRing.hpp"
+#include "FrameBuffers.hpp"
+#include "FramePacer.hpp"
 #include "peripherals/Video.hpp"
 #include "spectrum/Spectrum.hpp"
 #include "z80/v2/Z80.hpp"
@@ -5,6 +8,7 @@
 #include <cstdint>
 #include <format>
 #include <iostream>
+#include <optional>
 #include <vector>
 
 #include "spectrum/Snapshot.hpp"
@@ -19,13 +23,19 @@ extern "C" void __cxa_throw(const void *p, const std::type_info *tinfo, void (*)
 
 struct WebSpectrum {
   specbolt::Spectrum<specbolt::v2::Z80> spectrum{specbolt::Variant::Spectrum48, "assets/48.rom", 16000};
-  std::vector<std::uint32_t> frame;
+  FrameBuffers frames{specbolt::Video::VisibleHeight * specbolt::Video::VisibleWidth};
   std::vector<std::int16_t> audio;
+  AudioRing audio_ring;
+  bool use_audio_ring{};
+  // Paced by the ring, the worklet is kept two frames' worth of samples ahead.
+  FramePacer pacer;
   WebSpectrum(const specbolt::Variant variant, const char *rom, const std::size_t audio_sample_rate) :
-      spectrum(variant, rom, audio_sample_rate) {
-    frame.resize(specbolt::Video::VisibleHeight * specbolt::Video::VisibleWidth);
+      spectrum(variant, rom, audio_sample_rate), pacer(2 * audio_sample_rate / 50) {
     std::print(std::cout, "WebSpectrum {} / {}Hz\n", std::to_underlying(variant), audio_sample_rate);
   }
+  [[nodiscard]] std::optional<std::size_t> ring_waiting() const {
+    return use_audio_ring ? std::optional(audio_ring.waiting()) : std::nullopt;
+  }
 };
 
 extern "C" [[clang::export_name("create")]] WebSpectrum *create(
@@ -43,9 +53,27 @@ extern "C" [[clang::export_name("run_frame")]] std::size_t run_frame(WebSpectrum
   return ws.spectrum.run_frame();
 }
 
-extern "C" [[clang::export_name("render_video")]] void *render_video(WebSpectrum &ws) {
-  ws.spectrum.video().blit_to(ws.frame, true);
-  return ws.frame.data();
+// Draws the picture into a free frame buffer and returns its index, or -1 if the page still holds both.
+extern "C" [[clang::export_name("render_video")]] std::int32_t render_video(WebSpectrum &ws) {
+  const auto frame = ws.frames.next();
+  if (frame.empty())
+    return -1;
+  ws.spectrum.video().blit_to(frame, true);
+  return static_cast<std::int32_t>(ws.frames.publish());
+}
+
+extern "C" [[clang::export_name("video_frame")]] const std::uint32_t *video_frame(
+    const WebSpectrum &ws, const std::size_t index) {
+  return ws.frames.buffer(index);
+}
+
+extern "C" [[clang::export_name("video_frame_consumed")]] void video_frame_consumed(
+    WebSpectrum &ws, const std::size_t index) {
+  ws.frames.consumed(index);
+}
+
+extern "C" [[clang::export_name("video_frame_flags")]] const void *video_frame_flags(const WebSpectrum &ws) {
+  return ws.frames.flags();
 }
 
 extern "C" [[clang::export_name("render_audio")]] void *render_audio(WebSpectrum &ws) {
@@ -53,6 +81,38 @@ extern "C" [[clang::export_name("render_audio")]] void *render_audio(WebSpectrum
   return ws.audio.data();
 }
 
+// The alternative to render_audio when memory is shared: the audio worklet reads the samples straight from the ring.
+extern "C" [[clang::export_name("push_audio")]] std::size_t push_audio(WebSpectrum &ws) {
+  return ws.audio_ring.push(ws.spectrum.audio().end_frame(ws.spectrum.z80().cycle_count()));
+}
+
+extern "C" [[clang::export_name("use_audio_ring")]] void use_audio_ring(WebSpectrum &ws, const bool use) {
+  ws.use_audio_ring = use;
+}
+
+extern "C" [[clang::export_name("frame_due")]] bool frame_due(WebSpectrum &ws, const double now_ms) {
+  return ws.pacer.due(now_ms, ws.ring_waiting());
+}
+
+extern "C" [[clang::export_name("frame_ran")]] void frame_ran(WebSpectrum &ws, const double now_ms) {
+  ws.pacer.ran(now_ms, ws.ring_waiting());
+}
+
+extern "C" [[clang::export_name("restart_pacing")]] void restart_pacing(WebSpectrum &ws) { ws.pacer.restart(); }
+
+extern "C" [[clang::export_name("audio_ring_indices")]] const void *audio_ring_indices(const WebSpectrum &ws) {
+  return ws.audio_ring.indices();
+}
+
+extern "C" [[clang::export_name("audio_ring_samples")]] const std::int16_t *audio_ring_samples(
+    const WebSpectrum &ws) {
+  return ws.audio_ring.samples();
+}
+
+extern "C" [[clang::export_name("audio_ring_capacity")]] std::size_t audio_ring_capacity() {
+  return AudioRing::Capacity;
+}
+
 extern "C" [[clang::export_name("last_audio_frame_size")]] std::size_t last_audio_frame_size(const WebSpectrum &ws) {
   return ws.audio.size();
 }
@@ -62,16 +122,15 @@ extern "C" [[clang::export_name("video_width")]] std::size_t video_width() { ret
 
 extern "C" [[clang::export_name("key_state")]] void key_state(
     WebSpectrum &ws, const std::int32_t key_code, const bool pressed_or_released) {
-  auto &kb = ws.spectrum.keyboard();
   if (pressed_or_released)
-    kb.key_down(key_code);
+    ws.spectrum.key_down(key_code);
   else
-    kb.key_up(key_code);
+    ws.spectrum.key_up(key_code);
 }
 
 extern "C" [[clang::export_name("load_snapshot")]] void load_snapshot(WebSpectrum &ws, const char *name) {
   std::print(std::cout, "Loading snapshot '{}'\n", name);
-  specbolt::Snapshot::load(name, ws.spectrum.z80());
+  specbolt::Snapshot::load(name, ws.spectrum);
 }
 
 extern "C" [[clang::export_name("load_tape")]] void load_tape(WebSpectrum &ws, const char *name) {
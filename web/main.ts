@@ -91,8 +91,7 @@ async function initialise() {
         await spectrum.loadTape(game_url);
     }
 
-    for (let i = 0; i < 80; ++i)
-        spectrum.emulateFrame();
+    await spectrum.emulateFrames(80);
 
     if (!parsedQuery.get("autostart"))
         spectrum.start();
@@ -1,100 +1,5 @@
-import {ConsoleStdout, File, Inode, OpenFile, PreopenDirectory, WASI} from "@bjorn3/browser_wasi_shim";
-// @ts-ignore
-import wasmUrl from '@spectrum.wasm?url';
-
-// @ts-ignore
-import rom128Url from '../assets/128.rom?url';
-// @ts-ignore
-import rom48Url from '../assets/48.rom?url';
-
 import {AudioHandler} from "./audio-handler";
-
-async function initialiseWasm() {
-    const rom48 = await (await fetch(rom48Url)).arrayBuffer();
-    const rom128 = await (await fetch(rom128Url)).arrayBuffer();
-    const data = new Map();
-    const wasi = new WASI([], [], [
-        new OpenFile(new File([])), // stdin
-        ConsoleStdout.lineBuffered(msg => console.log(`[WASI stdout] ${msg}`)),
-        ConsoleStdout.lineBuffered(msg => console.warn(`[WASI stderr] ${msg}`)),
-        new PreopenDirectory("assets", new Map([
-            ["48.rom", new File(rom48)],
-            ["128.rom", new File(rom128)],
-        ])),
-        new PreopenDirectory("data", data)
-    ]);
-
-    const result = await WebAssembly.instantiateStreaming(fetch(wasmUrl), {"wasi_snapshot_preview1": wasi.wasiImport});
-    wasi.start(result.instance as any);
-    return {instance: result.instance, data};
-}
-
-const SampleRate = 48000;
-
-class WasmSpectrum {
-    private readonly _instance: number;
-    readonly width: number;
-    readonly height: number;
-    private readonly _exports: any;
-    private readonly data_map: Map<string, Inode>;
-
-    constructor(exports: Record<string, any>, model: number, data_map: Map<string, Inode>) {
-        this._exports = exports;
-        this._instance = exports.create(model, SampleRate);
-        this.width = exports.video_width();
-        this.height = exports.video_height();
-        this.data_map = data_map;
-    }
-
-    _alloc_string(name: string): number {
-        const length = name.length + 1;
-        const offset = this._exports.alloc_bytes(length);
-        const buffer = new Uint8Array(this._exports.memory.buffer, offset, length);
-        for (let index = 0; index < name.length; ++index) {
-            buffer[index] = name.charCodeAt(index);
-        }
-        buffer[length - 1] = 0;
-        return offset;
-    }
-
-    _free_string(offset: number) {
-        this._exports.free_bytes(offset);
-    }
-
-    load_snapshot(name: string, data: ArrayBuffer) {
-        this.data_map.set(name, new File(data));
-        const offset = this._alloc_string(`data/${name}`);
-        this._exports.load_snapshot(this._instance, offset);
-        this._free_string(offset);
-    }
-
-    load_tape(name: string, data: ArrayBuffer) {
-        this.data_map.set(name, new File(data));
-        const offset = this._alloc_string(`data/${name}`);
-        this._exports.load_tape(this._instance, offset);
-        this._free_string(offset);
-    }
-
-    run_frame() {
-        return this._exports.run_frame(this._instance);
-    }
-
-    render_video() {
-        const video = this._exports.render_video(this._instance);
-        const data = new Uint8ClampedArray(this._exports.memory.buffer, video, 4 * this.width * this.height);
-        return new ImageData(data, this.width, this.height);
-    }
-
-    render_audio() {
-        const audio = this._exports.render_audio(this._instance);
-        const length = this._exports.last_audio_frame_size(this._instance);
-        return new Int16Array(this._exports.memory.buffer, audio, length);
-    }
-
-    key_state(code: number, pressed: boolean) {
-        this._exports.key_state(this._instance, code, pressed);
-    }
-}
+import {EmulatorReply, EmulatorRequest, SampleRate} from "./emulator-messages";
 
 export const SpectrumShift = 0x400000e1;
 export const SymbolShift = 0x400000e0;
@@ -127,6 +32,7 @@ function keyCode(evt: KeyboardEvent) {
 
 const emulatedFrameEvent = new Event("emulated-frame");
 
+// The emulator itself runs in a worker, leaving this thread free to draw and take input.
 export class Spectrum {
     private readonly canvas: HTMLCanvasElement;
     private readonly canvas2d: CanvasRenderingContext2D;
@@ -135,9 +41,18 @@ export class Spectrum {
     effectiveMhz: number;
     prevFrameTime: number;
     running: boolean;
-    nextUpdate: number | undefined;
-    private wasm: WasmSpectrum;
+    private worker: Worker;
     private audioHandler: AudioHandler;
+    // Only in the threaded build, where frames arrive as offsets into it.
+    private memory: WebAssembly.Memory | undefined;
+    // Also only in the threaded build: a flag for each frame buffer, which is cleared to hand it back to the worker.
+    private frameFlags: Int32Array | undefined;
+    private image: ImageData;
+    // The most recent frame, and the buffer it's in, until it's drawn.
+    private latestVideo: number | Uint8ClampedArray | undefined;
+    private latestBuffer: number;
+    // Resolves the requests still waiting for the worker, oldest first.
+    private readonly pending: Array<() => void>;
 
     constructor(canvas: HTMLCanvasElement, audioWarningNode: HTMLElement) {
         this.canvas = canvas;
@@ -147,21 +62,72 @@ export class Spectrum {
         this.effectiveMhz = 0;
         this.prevFrameTime = performance.now();
         this.running = false;
-        this.nextUpdate = undefined;
+        this.latestVideo = undefined;
+        this.pending = [];
     }
 
     async initialise(model: number) {
-        const {instance, data} = await initialiseWasm();
-        this.wasm = new WasmSpectrum(instance.exports, model, data);
-        this.canvas.setAttribute('width', this.wasm.width.toString());
-        this.canvas.setAttribute('height', this.wasm.height.toString());
-
         this.audioHandler = new AudioHandler(this.audioWarningNode, SampleRate);
         await this.audioHandler.initialise();
+
+        this.worker = new Worker(new URL("./emulator-worker.ts", import.meta.url), {type: "module"});
+        this.worker.onmessage = (event: MessageEvent<EmulatorReply>) => this.onReply(event.data);
+        const audioPort = this.audioHandler.createAudioPort();
+        await this.request({type: "init", model, audioPort}, audioPort ? [audioPort] : []);
+    }
+
+    private request(request: EmulatorRequest, transfer: Transferable[] = []) {
+        return new Promise<void>((resolve) => {
+            this.pending.push(resolve);
+            this.worker.postMessage(request, transfer);
+        });
+    }
+
+    private post(request: EmulatorRequest) {
+        this.worker.postMessage(request);
+    }
+
+    private onReply(reply: EmulatorReply) {
+        switch (reply.type) {
+            case "ready":
+                this.memory = reply.memory;
+                if (reply.memory !== undefined)
+                    this.frameFlags = new Int32Array(reply.memory.buffer, reply.frameFlags, 2);
+                this.image = new ImageData(reply.width, reply.height);
+                this.canvas.setAttribute('width', reply.width.toString());
+                this.canvas.setAttribute('height', reply.height.toString());
+                this.pending.shift()();
+                break;
+            case "frame":
+                // A newer frame supersedes one still waiting to be drawn, whose buffer can go back.
+                this.releaseVideo();
+                this.latestVideo = reply.video;
+                this.latestBuffer = reply.buffer;
+                this.effectiveMhz = reply.effectiveMhz;
+                this.canvas.dispatchEvent(emulatedFrameEvent);
+                break;
+            case "done":
+                this.pending.shift()();
+                break;
+        }
     }
 
     blitSpectrumFrame() {
-        this.canvas2d.putImageData(this.wasm.render_video(), 0, 0);
+        if (this.latestVideo === undefined)
+            return;
+        const pixels = this.image.data;
+        if (typeof this.latestVideo === "number")
+            pixels.set(new Uint8ClampedArray(this.memory.buffer, this.latestVideo, pixels.length));
+        else
+            pixels.set(this.latestVideo);
+        this.releaseVideo();
+        this.canvas2d.putImageData(this.image, 0, 0);
+    }
+
+    private releaseVideo() {
+        if (typeof this.latestVideo === "number")
+            Atomics.store(this.frameFlags, this.latestBuffer, 0);
+        this.latestVideo = undefined;
     }
 
     drawFrame(ts: number) {
@@ -172,45 +138,26 @@ export class Spectrum {
             requestAnimationFrame((ts) => this.drawFrame(ts));
     }
 
-    emulateFrame() {
-        this.canvas.dispatchEvent(emulatedFrameEvent);
-        return this.wasm.run_frame();
-    }
-
-    emulate() {
-        const ts = performance.now();
-        if (this.nextUpdate === undefined)
-            this.nextUpdate = ts;
-        if (ts >= this.nextUpdate) {
-            const numCycles = this.emulateFrame();
-            const timeTakenMs = performance.now() - ts;
-            this.effectiveMhz = numCycles / timeTakenMs / 1000;
-            const audio = this.wasm.render_audio();
-            this.audioHandler.postAudio(audio);
-            // Schedule the next tick, but don't let us get stupidly behind.
-            const msPerUpdate = 1000 / 50;
-            const maxMsBehind = 1000;
-            this.nextUpdate = Math.max(ts - maxMsBehind, this.nextUpdate + msPerUpdate);
-        }
-        if (this.running)
-            setTimeout(() => this.emulate(), 0);
+    async emulateFrames(count: number) {
+        await this.request({type: "run_frames", count});
+        this.blitSpectrumFrame();
     }
 
     start() {
         if (this.running)
             return;
         this.running = true;
-        this.nextUpdate = undefined;
-        setTimeout(() => this.emulate(), 0);
+        this.post({type: "start"});
         requestAnimationFrame((ts) => this.drawFrame(ts));
     }
 
     stop() {
         this.running = false;
+        this.post({type: "stop"});
     }
 
     setKeyState(code: number, pressed: boolean) {
-        this.wasm.key_state(code, pressed);
+        this.post({type: "key", code, pressed});
     }
 
     onKeyDown(evt: KeyboardEvent) {
@@ -244,13 +191,13 @@ export class Spectrum {
 
     async loadTape(tape_url: URL) {
         const {filename, data} = await Spectrum.loadUrl(tape_url);
-        this.wasm.load_tape(filename, data);
+        await this.request({type: "load_tape", name: filename, data}, [data]);
     }
 
     async loadSnapshot(game_url: URL) {
         const {filename, data} = await Spectrum.loadUrl(game_url);
-        this.wasm.load_snapshot(filename, data);
-        this.wasm.run_frame();
+        // The worker runs a frame after loading, so there's something to show.
+        await this.request({type: "load_snapshot", name: filename, data}, [data]);
         this.blitSpectrumFrame();
     }
 }
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "AudioRing.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+std::vector<std::int16_t> counting(const std::size_t count, const std::int16_t first = 0) {
+  std::vector<std::int16_t> samples(count);
+  std::iota(samples.begin(), samples.end(), first);
+  return samples;
+}
+
+} // namespace
+
+TEST_CASE("audio ring tests", "[AudioRing]") {
+  const auto ring = std::make_unique<AudioRing>();
+
+  SECTION("starts empty") {
+    CHECK(ring->waiting() == 0);
+    std::vector<std::int16_t> out(16);
+    CHECK(ring->pop(out) == 0);
+  }
+
+  SECTION("gives back what was pushed, in order") {
+    CHECK(ring->push(counting(100)) == 100);
+    CHECK(ring->push(counting(50, 100)) == 150);
+    CHECK(ring->waiting() == 150);
+    std::vector<std::int16_t> out(200);
+    REQUIRE(ring->pop(out) == 150);
+    out.resize(150);
+    CHECK(out == counting(150));
+    CHECK(ring->waiting() == 0);
+  }
+
+  SECTION("pops no more than asked") {
+    ring->push(counting(10));
+    std::vector<std::int16_t> out(4);
+    CHECK(ring->pop(out) == 4);
+    CHECK(out == counting(4));
+    CHECK(ring->waiting() == 6);
+  }
+
+  SECTION("holds at most its capacity, dropping the rest") {
+    CHECK(ring->push(counting(AudioRing::Capacity - 10)) == AudioRing::Capacity - 10);
+    CHECK(ring->push(counting(100, 1000)) == AudioRing::Capacity);
+    CHECK(ring->push(counting(1)) == AudioRing::Capacity);
+    std::vector<std::int16_t> out(AudioRing::Capacity + 100);
+    REQUIRE(ring->pop(out) == AudioRing::Capacity);
+    // The first 10 of the second push made it in, and nothing of the third.
+    CHECK(out[AudioRing::Capacity - 11] == static_cast<std::int16_t>(AudioRing::Capacity - 11));
+    CHECK(out[AudioRing::Capacity - 10] == 1000);
+    CHECK(out[AudioRing::Capacity - 1] == 1009);
+  }
+
+  SECTION("makes room as it's read") {
+    ring->push(counting(AudioRing::Capacity));
+    std::vector<std::int16_t> out(100);
+    ring->pop(out);
+    CHECK(ring->push(counting(200)) == AudioRing::Capacity);
+    CHECK(ring->waiting() == AudioRing::Capacity);
+  }
+
+  SECTION("wraps around the end of its buffer") {
+    // A frame's worth at a time, several times round, each read back whole and in order.
+    constexpr auto Chunk = 960uz;
+    std::vector<std::int16_t> out(Chunk);
+    for (auto chunk = 0uz; chunk < 5 * AudioRing::Capacity / Chunk; ++chunk) {
+      const auto first = static_cast<std::int16_t>(chunk * Chunk);
+      INFO(chunk);
+      REQUIRE(ring->push(counting(Chunk, first)) == Chunk);
+      REQUIRE(ring->pop(out) == Chunk);
+      REQUIRE(out == counting(Chunk, first));
+    }
+    CHECK(ring->waiting() == 0);
+  }
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "FrameBuffers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+TEST_CASE("frame buffer tests", "[FrameBuffers]") {
+  FrameBuffers frames{16};
+  const auto draw = [&](const std::uint32_t colour) -> std::optional<std::size_t> {
+    const auto frame = frames.next();
+    if (frame.empty())
+      return std::nullopt;
+    std::ranges::fill(frame, colour);
+    return frames.publish();
+  };
+
+  SECTION("alternates while the page keeps up") {
+    const auto first = draw(1);
+    REQUIRE(first);
+    frames.consumed(*first);
+    const auto second = draw(2);
+    REQUIRE(second);
+    CHECK(*second != *first);
+    frames.consumed(*second);
+    CHECK(draw(3) == first);
+  }
+
+  SECTION("leaves the frame the page is holding alone") {
+    const auto held = draw(1);
+    REQUIRE(held);
+    const auto other = draw(2);
+    REQUIRE(other);
+    CHECK(*other != *held);
+    CHECK(frames.buffer(*held)[0] == 1);
+    // The page has both, so the next picture is skipped.
+    CHECK(!draw(3));
+    CHECK(frames.buffer(*held)[0] == 1);
+    CHECK(frames.buffer(*other)[0] == 2);
+    // Once it hands one back, that's the one drawn into.
+    frames.consumed(*held);
+    CHECK(draw(4) == held);
+    CHECK(frames.buffer(*held)[0] == 4);
+    CHECK(frames.buffer(*other)[0] == 2);
+  }
+
+  SECTION("prefers the older frame if both are free") {
+    const auto older = draw(1);
+    REQUIRE(older);
+    const auto newer = draw(2);
+    REQUIRE(newer);
+    frames.consumed(*newer);
+    frames.consumed(*older);
+    CHECK(draw(3) == older);
+  }
+
+  SECTION("flags the frames the page has yet to finish with") {
+    const auto *flags = static_cast<const std::atomic<std::uint32_t> *>(frames.flags());
+    CHECK(flags[0] == 0);
+    CHECK(flags[1] == 0);
+    const auto index = draw(1);
+    REQUIRE(index);
+    CHECK(flags[*index] == 1);
+    CHECK(flags[*index ^ 1] == 0);
+    frames.consumed(*index);
+    CHECK(flags[*index] == 0);
+  }
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "FramePacer.hpp"
+
+#include <cstddef>
+#include <optional>
+
+TEST_CASE("frame pacer tests", "[FramePacer]") {
+  constexpr auto Target = 1920uz;
+  FramePacer pacer{Target};
+  // Runs every frame that's due at `now`, as the worker does, and returns how many that was.
+  const auto run_due = [&](const double now, const std::optional<std::size_t> ring = std::nullopt) {
+    auto frames = 0;
+    while (pacer.due(now, ring) && frames < 1000) {
+      pacer.ran(now, ring);
+      ++frames;
+    }
+    return frames;
+  };
+
+  SECTION("runs a frame every 20ms by the wall clock") {
+    CHECK(run_due(1000) == 1);
+    CHECK(run_due(1010) == 0);
+    CHECK(run_due(1019.9) == 0);
+    CHECK(run_due(1020) == 1);
+    CHECK(run_due(1045) == 1);
+    CHECK(run_due(1060) == 1);
+  }
+
+  SECTION("catches up on missed frames") {
+    CHECK(run_due(1000) == 1);
+    CHECK(run_due(1100) == 5);
+    CHECK(run_due(1110) == 0);
+    CHECK(run_due(1120) == 1);
+  }
+
+  SECTION("skips all but a second's worth of missed frames") {
+    CHECK(run_due(1000) == 1);
+    // The one that was due, then 10.02s to 11s.
+    CHECK(run_due(11'000) == 1 + 51);
+    CHECK(run_due(11'010) == 0);
+    CHECK(run_due(11'020) == 1);
+  }
+
+  SECTION("starts afresh after a restart") {
+    CHECK(run_due(1000) == 1);
+    pacer.restart();
+    CHECK(run_due(5000) == 1);
+    CHECK(run_due(5010) == 0);
+  }
+
+  SECTION("is paced by the ring while the worklet reads it") {
+    CHECK(run_due(1000, Target + 1000) == 1);
+    // The worklet has read some, so the ring now paces it: nothing till it's below the target.
+    CHECK(!pacer.due(1001, Target + 100));
+    CHECK(!pacer.due(1050, Target + 50));
+    CHECK(pacer.due(1060, Target - 1));
+    pacer.ran(1060, Target + 959);
+    // However late the wall clock says it is.
+    CHECK(!pacer.due(1070, Target + 900));
+    CHECK(!pacer.due(1200, Target + 800));
+    CHECK(pacer.due(1210, Target - 100));
+  }
+
+  SECTION("falls back on the wall clock when the worklet stops reading") {
+    CHECK(run_due(1000, Target + 1000) == 1);
+    CHECK(!pacer.due(1001, Target + 100));
+    // The ring doesn't go down for StallMs.
+    CHECK(!pacer.due(1100, Target + 100));
+    CHECK(pacer.due(1101, Target + 100));
+    pacer.ran(1101, Target + 1060);
+    // Then it's the frames due by the clock, at 1040ms to 1100ms.
+    CHECK(run_due(1110, Target + 1060) == 4);
+    // Until the worklet reads again.
+    CHECK(!pacer.due(1120, Target + 500));
+  }
+}
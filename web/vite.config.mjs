@@ -15,6 +15,11 @@ export default function({mode}) {
     }
 
     const spectrumWasm = path.resolve(`${build_dir}/web/spectrum.wasm`);
+    // Shared memory is only available to cross-origin isolated pages; whatever serves dist/ must send these too.
+    const headers = process.env.VITE_WASM_THREADS === "1" ? {
+        'Cross-Origin-Opener-Policy' : 'same-origin',
+        'Cross-Origin-Embedder-Policy' : 'credentialless',
+    } : {};
 
     return defineConfig({
         build : {
@@ -28,6 +33,11 @@ export default function({mode}) {
                 },
             }
         },
+        worker : {
+            format : 'es',
+        },
+        server : {headers},
+        preview : {headers},
         resolve : {
             alias : {
                 '@spectrum.wasm?url' : `${spectrumWasm}?url`,
@@ -0,0 +1,157 @@
+import {ConsoleStdout, File, Inode, OpenFile, PreopenDirectory, WASI} from "@bjorn3/browser_wasi_shim";
+// @ts-ignore
+import wasmUrl from '@spectrum.wasm?url';
+
+// @ts-ignore
+import rom128Url from '../assets/128.rom?url';
+// @ts-ignore
+import rom48Url from '../assets/48.rom?url';
+
+import {SampleRate} from "./emulator-messages";
+
+// Set by the SPECBOLT_WASM_THREADS build, whose module imports a shared memory rather than making its own.
+// @ts-ignore
+export const WasmThreads = import.meta.env.VITE_WASM_THREADS === "1";
+
+// In 64K WebAssembly pages; these must match the link options in CMakeLists.txt.
+const SharedMemoryPages = {initial: 512, maximum: 4096};
+
+export async function initialiseWasm() {
+    const rom48 = await (await fetch(rom48Url)).arrayBuffer();
+    const rom128 = await (await fetch(rom128Url)).arrayBuffer();
+    const data = new Map();
+    const wasi = new WASI([], [], [
+        new OpenFile(new File([])), // stdin
+        ConsoleStdout.lineBuffered(msg => console.log(`[WASI stdout] ${msg}`)),
+        ConsoleStdout.lineBuffered(msg => console.warn(`[WASI stderr] ${msg}`)),
+        new PreopenDirectory("assets", new Map([
+            ["48.rom", new File(rom48)],
+            ["128.rom", new File(rom128)],
+        ])),
+        new PreopenDirectory("data", data)
+    ]);
+
+    const imports: WebAssembly.Imports = {"wasi_snapshot_preview1": wasi.wasiImport};
+    if (WasmThreads) {
+        if (!crossOriginIsolated)
+            throw new Error("The threaded build needs the page to be cross-origin isolated");
+        imports.env = {memory: new WebAssembly.Memory({...SharedMemoryPages, shared: true})};
+    }
+    const result = await WebAssembly.instantiateStreaming(fetch(wasmUrl), imports);
+    wasi.start(result.instance as any);
+    return {instance: result.instance, data};
+}
+
+export class WasmSpectrum {
+    private readonly _instance: number;
+    readonly width: number;
+    readonly height: number;
+    private readonly _exports: any;
+    private readonly data_map: Map<string, Inode>;
+
+    constructor(exports: Record<string, any>, model: number, data_map: Map<string, Inode>) {
+        this._exports = exports;
+        this._instance = exports.create(model, SampleRate);
+        this.width = exports.video_width();
+        this.height = exports.video_height();
+        this.data_map = data_map;
+    }
+
+    get memory(): WebAssembly.Memory {
+        return this._exports.memory;
+    }
+
+    _alloc_string(name: string): number {
+        const length = name.length + 1;
+        const offset = this._exports.alloc_bytes(length);
+        const buffer = new Uint8Array(this._exports.memory.buffer, offset, length);
+        for (let index = 0; index < name.length; ++index) {
+            buffer[index] = name.charCodeAt(index);
+        }
+        buffer[length - 1] = 0;
+        return offset;
+    }
+
+    _free_string(offset: number) {
+        this._exports.free_bytes(offset);
+    }
+
+    load_snapshot(name: string, data: ArrayBuffer) {
+        this.data_map.set(name, new File(data));
+        const offset = this._alloc_string(`data/${name}`);
+        this._exports.load_snapshot(this._instance, offset);
+        this._free_string(offset);
+    }
+
+    load_tape(name: string, data: ArrayBuffer) {
+        this.data_map.set(name, new File(data));
+        const offset = this._alloc_string(`data/${name}`);
+        this._exports.load_tape(this._instance, offset);
+        this._free_string(offset);
+    }
+
+    run_frame() {
+        return this._exports.run_frame(this._instance);
+    }
+
+    // Draws the picture into whichever frame buffer the page isn't holding, returning its index and RGBA pixels, viewed
+    // in place in the module's memory; nothing if the page holds both.
+    render_video() {
+        const index = this._exports.render_video(this._instance);
+        if (index < 0)
+            return undefined;
+        const video = this._exports.video_frame(this._instance, index);
+        return {index, pixels: new Uint8ClampedArray(this._exports.memory.buffer, video, 4 * this.width * this.height)};
+    }
+
+    video_frame_consumed(index: number) {
+        this._exports.video_frame_consumed(this._instance, index);
+    }
+
+    // Where the frame buffers' flags are, for a page sharing the memory to say it's done with one.
+    video_frame_flags(): number {
+        return this._exports.video_frame_flags(this._instance);
+    }
+
+    render_audio() {
+        const audio = this._exports.render_audio(this._instance);
+        const length = this._exports.last_audio_frame_size(this._instance);
+        return new Int16Array(this._exports.memory.buffer, audio, length);
+    }
+
+    // Moves the frame's audio into the ring the worklet reads, returning how many samples are waiting there.
+    push_audio(): number {
+        return this._exports.push_audio(this._instance);
+    }
+
+    // Whether frames are paced by the ring rather than the wall clock; see FramePacer.hpp.
+    use_audio_ring(use: boolean) {
+        this._exports.use_audio_ring(this._instance, use);
+    }
+
+    frame_due(now: number): boolean {
+        return this._exports.frame_due(this._instance, now) !== 0;
+    }
+
+    frame_ran(now: number) {
+        this._exports.frame_ran(this._instance, now);
+    }
+
+    restart_pacing() {
+        this._exports.restart_pacing(this._instance);
+    }
+
+    // Where the ring is, for a worklet sharing the memory.
+    audio_ring() {
+        return {
+            buffer: this._exports.memory.buffer,
+            indices: this._exports.audio_ring_indices(this._instance),
+            samples: this._exports.audio_ring_samples(this._instance),
+            capacity: this._exports.audio_ring_capacity(),
+        };
+    }
+
+    key_state(code: number, pressed: boolean) {
+        this._exports.key_state(this._instance, code, pressed);
+    }
+}
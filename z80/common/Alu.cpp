@@ -1,53 +1,41 @@
 #ifndef SPECBOLT_MODULES
 #include "z80/common/Alu.hpp"
-
-#include <bit>
 #endif
 
 namespace specbolt {
 
 namespace {
 
-constexpr Flags sz53_8(const std::uint8_t value) {
-  return (Flags(value) & (Flags::Sign() | Flags::Flag3() | Flags::Flag5())) | (value == 0 ? Flags::Zero() : Flags());
-}
-constexpr Flags sz53_parity(const std::uint8_t value) {
-  return (Flags(value) & (Flags::Sign() | Flags::Flag3() | Flags::Flag5())) | (value == 0 ? Flags::Zero() : Flags()) |
-         (std::popcount(value) % 2 == 0 ? Flags::Parity() : Flags());
-}
+constexpr Flags sz53_8(const std::uint8_t value) { return Alu::sz53_table[value]; }
+constexpr Flags sz53_parity(const std::uint8_t value) { return Alu::sz53p_table[value]; }
 
 constexpr auto mask53 = Flags::Flag5() | Flags::Flag3();
 
 } // namespace
 
 Alu::R8 Alu::add8(const std::uint8_t lhs, const std::uint8_t rhs, const bool carry_in) {
-  const std::uint16_t intermediate =
-      static_cast<std::uint16_t>(static_cast<std::uint16_t>(lhs) + static_cast<std::uint16_t>(rhs)) +
-      static_cast<std::uint16_t>(carry_in);
-  const auto carry = intermediate > 0xff ? Flags::Carry() : Flags();
+  const auto intermediate = static_cast<unsigned>(lhs) + rhs + (carry_in ? 1u : 0u);
   const auto result = static_cast<std::uint8_t>(intermediate);
-  const auto half_carry = (lhs & 0xf) + (rhs & 0xf) + (carry_in ? 1 : 0) > 0xf ? Flags::HalfCarry() : Flags();
-  const auto overflow = (lhs ^ result) & (rhs ^ result) & 0x80 ? Flags::Overflow() : Flags();
-  return {result, sz53_8(result) | carry | half_carry | overflow};
+  const auto index = half_carry_overflow_index(lhs, rhs, result);
+  const auto carry = intermediate & 0x100 ? Flags::Carry() : Flags();
+  return {result, sz53_table[result] | carry | half_carry_add_table[index & 0x07] | overflow_add_table[index >> 4]};
 }
 
 Alu::R8 Alu::sub8(const std::uint8_t lhs, const std::uint8_t rhs, const bool carry_in) {
-  const auto [result, flags] = add8(lhs, static_cast<std::uint8_t>(~rhs), !carry_in);
-  return {result, (flags | Flags::Subtract()) ^ Flags::Carry() ^ Flags::HalfCarry()};
+  // Any borrow wraps the intermediate round, setting bit 8.
+  const auto intermediate = static_cast<unsigned>(lhs) - rhs - (carry_in ? 1u : 0u);
+  const auto result = static_cast<std::uint8_t>(intermediate);
+  const auto index = half_carry_overflow_index(lhs, rhs, result);
+  const auto carry = intermediate & 0x100 ? Flags::Carry() : Flags();
+  return {result, sz53_table[result] | Flags::Subtract() | carry | half_carry_sub_table[index & 0x07] |
+                      overflow_sub_table[index >> 4]};
 }
 
 Alu::R8 Alu::inc8(const std::uint8_t lhs, const Flags current_flags) {
-  const auto result = static_cast<std::uint8_t>(lhs + 1);
-  const auto flags = sz53_8(result) | (Flags(result) & mask53) | (Flags(result ^ lhs) & Flags::HalfCarry()) |
-                     (result == 0x80 ? Flags::Overflow() : Flags()) | (current_flags & Flags::Carry());
-  return {result, flags};
+  return {static_cast<std::uint8_t>(lhs + 1), inc8_table[lhs] | (current_flags & Flags::Carry())};
 }
 Alu::R8 Alu::dec8(const std::uint8_t lhs, const Flags current_flags) {
-  const auto result = static_cast<std::uint8_t>(lhs - 1);
-  const auto flags = Flags::Subtract() | sz53_8(result) | (Flags(result) & mask53) |
-                     (result == 0x7f ? Flags::Overflow() : Flags()) | (Flags(result ^ lhs) & Flags::HalfCarry()) |
-                     (current_flags & Flags::Carry());
-  return {result, flags};
+  return {static_cast<std::uint8_t>(lhs - 1), dec8_table[lhs] | (current_flags & Flags::Carry())};
 }
 
 Alu::R8 Alu::cmp8(const std::uint8_t lhs, const std::uint8_t rhs) {
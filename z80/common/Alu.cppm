@@ -1,5 +1,6 @@
 module;
 
+#include <array>
 #include <bit>
 #include <cstdint>
 
@@ -0,0 +1,11 @@
+module;
+
+#include <bit>
+#include <cstdint>
+
+export module z80_common:LazyFlags;
+
+import :Alu;
+import :Flags;
+
+#include "z80/common/LazyFlags.hpp"
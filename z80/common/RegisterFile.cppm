@@ -1,7 +1,9 @@
 module;
 
 #include <array>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string_view>
 
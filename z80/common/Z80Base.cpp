@@ -2,7 +2,9 @@
 #include "z80/common/Z80Base.hpp"
 #include "peripherals/Memory.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #endif
 
 namespace specbolt {
@@ -15,6 +17,93 @@ void Z80Base::halt() {
   regs().pc(regs().pc() - 1);
 }
 
+namespace {
+// Each repeat of a block instruction: the two opcode fetches (4 + 4), the memory access (3) and 5 more for the data
+// handling, then another 5 to rewind PC.
+constexpr std::size_t BlockRepeatTStates = 21;
+} // namespace
+
+std::size_t Z80Base::bulk_repeats_available() const {
+  // An interrupt would be taken between repeats, and a listener expects to see every access. Contended fetches make
+  // each repeat's timing depend on where in the frame it runs.
+  if (!accelerate_block_ops_ || irq_pending_ || memory_.has_listener() ||
+      subject_to_contention(static_cast<std::uint16_t>(regs_.pc() - 2)) ||
+      subject_to_contention(static_cast<std::uint16_t>(regs_.pc() - 1)))
+    return 0;
+  // The last iteration always runs normally so it can set the final flags. Stopping strictly before the next task means
+  // no task ever observes a bulk copy in progress.
+  const auto headroom = scheduler_.headroom();
+  if (headroom == 0)
+    return 0;
+  const auto bc = regs_.get(RegisterFile::R16::BC);
+  const auto iterations = bc == 0 ? 0x10000uz : bc;
+  return std::min(iterations - 1, (headroom - 1) / BlockRepeatTStates);
+}
+
+void Z80Base::skip_repeats(const std::size_t repeats, const bool increment, const bool moves_de) {
+  const auto delta = static_cast<std::uint16_t>(increment ? repeats : 0x10000 - repeats);
+  regs_.set(RegisterFile::R16::HL, static_cast<std::uint16_t>(regs_.get(RegisterFile::R16::HL) + delta));
+  if (moves_de)
+    regs_.set(RegisterFile::R16::DE, static_cast<std::uint16_t>(regs_.get(RegisterFile::R16::DE) + delta));
+  regs_.set(RegisterFile::R16::BC, static_cast<std::uint16_t>(regs_.get(RegisterFile::R16::BC) - repeats));
+  // Two refreshes per repeat, one for each opcode fetch.
+  regs_.r(static_cast<std::uint8_t>((regs_.r() & 0x80) | ((regs_.r() + 2 * repeats) & 0x7f)));
+  regs_.wz(regs_.pc() - 1);
+  pass_time(repeats * BlockRepeatTStates);
+}
+
+void Z80Base::bulk_block_load(const bool increment) {
+  const auto hl = regs_.get(RegisterFile::R16::HL);
+  const auto de = regs_.get(RegisterFile::R16::DE);
+  const auto repeats = std::min(
+      {bulk_repeats_available(), memory_.contiguous_bytes(hl, increment), memory_.contiguous_bytes(de, increment)});
+  // Each range lies within a page, so its first address says whether any of it is contended.
+  if (repeats == 0 || memory_.is_rom(de) || subject_to_contention(hl) || subject_to_contention(de))
+    return;
+  // A watcher needs to see each write as it happens.
+  if (memory_.watched(de, repeats, increment))
+    return;
+  // Stepping would execute whatever the copy turned the instruction into, so leave that case alone.
+  const auto dest_first = memory_.physical_address(increment ? de : static_cast<std::uint16_t>(de - repeats + 1));
+  for (const auto offset: {1, 2}) {
+    if (const auto opcode = memory_.physical_address(static_cast<std::uint16_t>(regs_.pc() - offset));
+        opcode >= dest_first && opcode < dest_first + repeats)
+      return;
+  }
+  memory_.copy_block(hl, de, repeats, increment);
+  skip_repeats(repeats, increment, true);
+}
+
+void Z80Base::bulk_block_compare(const bool increment) {
+  const auto hl = regs_.get(RegisterFile::R16::HL);
+  const auto limit = std::min(bulk_repeats_available(), memory_.contiguous_bytes(hl, increment));
+  if (limit == 0 || subject_to_contention(hl))
+    return;
+  // Stop short of any match so its iteration runs normally.
+  const auto repeats = memory_.find_byte(hl, limit, increment, regs_.get(RegisterFile::R8::A));
+  if (repeats == 0)
+    return;
+  skip_repeats(repeats, increment, false);
+}
+
+void Z80Base::pass_halted_time() {
+  constexpr std::size_t NopTStates = 4;
+  if (subject_to_contention(regs_.pc())) {
+    // Each NOP's fetch can be held up differently, so they have to be taken one at a time.
+    contend(regs_.pc());
+    regs_.r(static_cast<std::uint8_t>((regs_.r() & 0x80) | ((regs_.r() + 1) & 0x7f)));
+    pass_time(NopTStates);
+    return;
+  }
+  const auto headroom = scheduler_.headroom();
+  // With nothing scheduled there's no end in sight, so just run one NOP at a time.
+  const auto nops = headroom == std::numeric_limits<std::size_t>::max()
+                        ? 1
+                        : std::max(1uz, (headroom + NopTStates - 1) / NopTStates);
+  regs_.r(static_cast<std::uint8_t>((regs_.r() & 0x80) | ((regs_.r() + nops) & 0x7f)));
+  pass_time(nops * NopTStates);
+}
+
 void Z80Base::add_out_handler(OutHandler handler) { out_handlers_.emplace_back(std::move(handler)); }
 void Z80Base::add_in_handler(InHandler handler) { in_handlers_.emplace_back(std::move(handler)); }
 
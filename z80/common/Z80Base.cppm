@@ -1,9 +1,12 @@
 module;
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <optional>
+#include <span>
 #include <vector>
 
 export module z80_common:Z80Base;
@@ -1,6 +1,8 @@
 #pragma once
 
 #ifndef SPECBOLT_MODULES
+#include <array>
+#include <bit>
 #include <cstdint>
 
 #include "Flags.hpp"
@@ -60,6 +62,61 @@ public:
   static R8 rotate_circular8(std::uint8_t lhs, Direction direction);
   static R8 shift_logical8(std::uint8_t lhs, Direction direction);
   static R8 shift_arithmetic8(std::uint8_t lhs, Direction direction);
+
+  // Flag lookup tables, built at compile time.
+  // Sign, zero, and the undocumented bits 3 and 5, by result; sz53p_table adds parity.
+  static constexpr auto sz53_table = [] {
+    std::array<Flags, 256> table{};
+    for (auto value = 0u; value < table.size(); ++value) {
+      table[value] = (Flags(static_cast<std::uint8_t>(value)) & (Flags::Sign() | Flags::Flag3() | Flags::Flag5())) |
+                     (value == 0 ? Flags::Zero() : Flags());
+    }
+    return table;
+  }();
+  static constexpr auto sz53p_table = [] {
+    std::array<Flags, 256> table{};
+    for (auto value = 0u; value < table.size(); ++value)
+      table[value] = sz53_table[value] | (std::popcount(value) % 2 == 0 ? Flags::Parity() : Flags());
+    return table;
+  }();
+  // All of INC and DEC's flags except the preserved carry, by operand.
+  static constexpr auto inc8_table = [] {
+    std::array<Flags, 256> table{};
+    for (auto value = 0u; value < table.size(); ++value) {
+      const auto result = static_cast<std::uint8_t>(value + 1);
+      table[value] = sz53_table[result] | ((result & 0xf) == 0 ? Flags::HalfCarry() : Flags()) |
+                     (result == 0x80 ? Flags::Overflow() : Flags());
+    }
+    return table;
+  }();
+  static constexpr auto dec8_table = [] {
+    std::array<Flags, 256> table{};
+    for (auto value = 0u; value < table.size(); ++value) {
+      const auto result = static_cast<std::uint8_t>(value - 1);
+      table[value] = Flags::Subtract() | sz53_table[result] | ((value & 0xf) == 0 ? Flags::HalfCarry() : Flags()) |
+                     (result == 0x7f ? Flags::Overflow() : Flags());
+    }
+    return table;
+  }();
+  // Half carry and overflow for 8-bit add and subtract, indexed by one bit each from the lhs, rhs and result: bit 3 of
+  // each for half carry, bit 7 for overflow. See half_carry_overflow_index().
+  static constexpr std::array half_carry_add_table{
+      Flags(), Flags::HalfCarry(), Flags::HalfCarry(), Flags::HalfCarry(), //
+      Flags(), Flags(), Flags(), Flags::HalfCarry()};
+  static constexpr std::array half_carry_sub_table{
+      Flags(), Flags(), Flags::HalfCarry(), Flags(), //
+      Flags::HalfCarry(), Flags(), Flags::HalfCarry(), Flags::HalfCarry()};
+  static constexpr std::array overflow_add_table{
+      Flags(), Flags(), Flags(), Flags::Overflow(), //
+      Flags::Overflow(), Flags(), Flags(), Flags()};
+  static constexpr std::array overflow_sub_table{
+      Flags(), Flags::Overflow(), Flags(), Flags(), //
+      Flags(), Flags(), Flags::Overflow(), Flags()};
+  // Bits 0-2 are bit 3 of lhs, rhs and result; bits 4-6 are their bit 7s.
+  [[nodiscard]] static constexpr std::uint8_t half_carry_overflow_index(
+      const std::uint8_t lhs, const std::uint8_t rhs, const std::uint8_t result) {
+    return static_cast<std::uint8_t>((lhs & 0x88) >> 3 | (rhs & 0x88) >> 2 | (result & 0x88) >> 1);
+  }
 };
 
 } // namespace specbolt
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef SPECBOLT_MODULES
+#include <bit>
+#include <cstdint>
+
+#include "Alu.hpp"
+#include "Flags.hpp"
+#endif
+
+namespace specbolt {
+
+// Records the last 8-bit ALU operation instead of computing its flags. Most flag results are overwritten before
+// anything reads them, so the full Flags byte is only built by evaluate(); the conditions used by branches can be
+// answered individually and cheaply from the recorded operands.
+SPECBOLT_EXPORT
+class LazyFlags {
+public:
+  enum class Op : std::uint8_t { None, Add8, Sub8, Cmp8, And8, Xor8, Or8, Inc8, Dec8 };
+
+  // Records `op` and returns its result. For Inc8 and Dec8 `rhs` is ignored and `carry_in` is the carry to preserve;
+  // compare and the logical operations ignore `carry_in`.
+  template<Op op>
+  constexpr std::uint8_t defer(const std::uint8_t lhs, const std::uint8_t rhs, const bool carry_in) {
+    op_ = op;
+    lhs_ = lhs;
+    rhs_ = rhs;
+    carry_in_ = carry_in && op != Op::Cmp8 && op != Op::And8 && op != Op::Xor8 && op != Op::Or8;
+    if constexpr (op == Op::Add8)
+      result_ = static_cast<std::uint8_t>(lhs + rhs + (carry_in ? 1 : 0));
+    else if constexpr (op == Op::Sub8 || op == Op::Cmp8)
+      result_ = static_cast<std::uint8_t>(lhs - rhs - (carry_in_ ? 1 : 0));
+    else if constexpr (op == Op::And8)
+      result_ = static_cast<std::uint8_t>(lhs & rhs);
+    else if constexpr (op == Op::Xor8)
+      result_ = static_cast<std::uint8_t>(lhs ^ rhs);
+    else if constexpr (op == Op::Or8)
+      result_ = static_cast<std::uint8_t>(lhs | rhs);
+    else if constexpr (op == Op::Inc8)
+      result_ = static_cast<std::uint8_t>(lhs + 1);
+    else if constexpr (op == Op::Dec8)
+      result_ = static_cast<std::uint8_t>(lhs - 1);
+    else
+      static_assert(false, "can't defer this operation");
+    // Compare leaves A alone, so hand back the original value.
+    return op == Op::Cmp8 ? lhs : result_;
+  }
+
+  [[nodiscard]] constexpr bool pending() const { return op_ != Op::None; }
+  constexpr void clear() { op_ = Op::None; }
+
+  [[nodiscard]] constexpr bool zero() const { return result_ == 0; }
+  [[nodiscard]] constexpr bool sign() const { return result_ & 0x80; }
+  [[nodiscard]] constexpr bool carry() const {
+    switch (op_) {
+      case Op::Add8: return lhs_ + rhs_ + (carry_in_ ? 1 : 0) > 0xff;
+      case Op::Sub8:
+      case Op::Cmp8: return lhs_ < rhs_ + (carry_in_ ? 1 : 0);
+      case Op::Inc8:
+      case Op::Dec8: return carry_in_;
+      default: return false;
+    }
+  }
+  // Parity for the logical operations, overflow for the arithmetic ones.
+  [[nodiscard]] constexpr bool parity() const {
+    switch (op_) {
+      case Op::Add8: return (lhs_ ^ result_) & (rhs_ ^ result_) & 0x80;
+      case Op::Sub8:
+      case Op::Cmp8: return (lhs_ ^ rhs_) & (lhs_ ^ result_) & 0x80;
+      case Op::Inc8: return result_ == 0x80;
+      case Op::Dec8: return result_ == 0x7f;
+      default: return std::popcount(result_) % 2 == 0;
+    }
+  }
+
+  // The complete flags of the pending operation, exactly as the eager Alu would have produced them.
+  [[nodiscard]] Flags evaluate() const {
+    const auto carry_flags = carry_in_ ? Flags::Carry() : Flags();
+    switch (op_) {
+      case Op::Add8: return Alu::add8(lhs_, rhs_, carry_in_).flags;
+      case Op::Sub8: return Alu::sub8(lhs_, rhs_, carry_in_).flags;
+      case Op::Cmp8: return Alu::cmp8(lhs_, rhs_).flags;
+      case Op::And8: return Alu::and8(lhs_, rhs_).flags;
+      case Op::Xor8: return Alu::xor8(lhs_, rhs_).flags;
+      case Op::Or8: return Alu::or8(lhs_, rhs_).flags;
+      case Op::Inc8: return Alu::inc8(lhs_, carry_flags).flags;
+      case Op::Dec8: return Alu::dec8(lhs_, carry_flags).flags;
+      case Op::None: break;
+    }
+    return {};
+  }
+
+private:
+  Op op_{Op::None};
+  std::uint8_t lhs_{};
+  std::uint8_t rhs_{};
+  std::uint8_t result_{};
+  bool carry_in_{};
+};
+
+} // namespace specbolt
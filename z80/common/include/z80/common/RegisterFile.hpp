@@ -2,7 +2,9 @@
 
 #ifndef SPECBOLT_MODULES
 #include <array>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <iosfwd>
 #include <string_view>
 #endif
@@ -16,53 +18,89 @@ public:
   enum class R16 { AF, BC, DE, HL, AF_, BC_, DE_, HL_, SP, IX, IY };
 
   // Paired registers.
-  [[nodiscard]] std::uint8_t get(R8 reg) const;
-  void set(R8 reg, std::uint8_t value);
-  [[nodiscard]] std::uint16_t get(R16 reg) const;
-  void set(R16 reg, std::uint16_t value);
+  [[nodiscard]] constexpr std::uint8_t get(const R8 reg) const { return bytes_[byte_index(reg)]; }
+  constexpr void set(const R8 reg, const std::uint8_t value) { bytes_[byte_index(reg)] = value; }
+  [[nodiscard]] constexpr std::uint16_t get(const R16 reg) const { return load16(pair_offset(reg)); }
+  constexpr void set(const R16 reg, const std::uint16_t value) { store16(pair_offset(reg), value); }
 
   // Convenience named registers.
-  [[nodiscard]] std::uint16_t ix() const;
-  [[nodiscard]] std::uint16_t iy() const;
-  [[nodiscard]] std::uint16_t sp() const;
-  void sp(std::uint16_t sp);
+  [[nodiscard]] constexpr std::uint16_t ix() const { return get(R16::IX); }
+  [[nodiscard]] constexpr std::uint16_t iy() const { return get(R16::IY); }
+  [[nodiscard]] constexpr std::uint16_t sp() const { return get(R16::SP); }
+  constexpr void sp(const std::uint16_t sp) { set(R16::SP, sp); }
 
   // Special registers.
-  [[nodiscard]] std::uint16_t pc() const;
-  void pc(std::uint16_t pc);
-  [[nodiscard]] std::uint8_t r() const;
-  void r(std::uint8_t r);
-  [[nodiscard]] std::uint8_t i() const;
-  void i(std::uint8_t i);
+  [[nodiscard]] constexpr std::uint16_t pc() const { return pc_; }
+  constexpr void pc(const std::uint16_t pc) { pc_ = pc; }
+  [[nodiscard]] constexpr std::uint8_t r() const { return r_; }
+  constexpr void r(const std::uint8_t r) { r_ = r; }
+  [[nodiscard]] constexpr std::uint8_t i() const { return i_; }
+  constexpr void i(const std::uint8_t i) { i_ = i; }
 
-  [[nodiscard]] std::uint16_t wz() const;
-  void wz(std::uint16_t wz);
+  [[nodiscard]] constexpr std::uint16_t wz() const { return wz_; }
+  constexpr void wz(const std::uint16_t wz) { wz_ = wz; }
 
-  void exx();
-  void ex(R16 lhs, R16 rhs);
+  constexpr void exx() {
+    ex(R16::BC, R16::BC_);
+    ex(R16::DE, R16::DE_);
+    ex(R16::HL, R16::HL_);
+  }
+  constexpr void ex(const R16 lhs, const R16 rhs) {
+    const auto lhs_value = get(lhs);
+    set(lhs, get(rhs));
+    set(rhs, lhs_value);
+  }
 
   void dump(std::ostream &to, std::string_view prefix) const;
 
+  [[nodiscard]] constexpr bool operator==(const RegisterFile &) const = default;
+
 private:
-  class RegPair {
-  public:
-    [[nodiscard]] std::uint8_t high() const;
-    void high(std::uint8_t high);
-    [[nodiscard]] std::uint8_t low() const;
-    void low(std::uint8_t low);
-    [[nodiscard]] std::uint16_t highlow() const;
-    void highlow(std::uint16_t highlow);
+  // All the paired registers live in one flat array, two bytes per pair in the host's byte order, so a 16-bit access
+  // is a single load or store and an 8-bit access is a byte at a fixed offset. Both indices are compile-time constants
+  // whenever the register is.
+  static constexpr bool little_endian = std::endian::native == std::endian::little;
+  static constexpr std::size_t NumPairs = 11;
+
+  // R8 values come in (high, low) pairs, matching the R16 value of their pair.
+  [[nodiscard]] static constexpr std::size_t byte_index(const R8 reg) {
+    const auto index = static_cast<std::size_t>(reg);
+    const auto is_low = index & 1;
+    return (index & ~1uz) + (little_endian ? 1 - is_low : is_low);
+  }
+  [[nodiscard]] static constexpr std::size_t pair_offset(const R16 reg) { return static_cast<std::size_t>(reg) * 2; }
 
-  private:
-    std::uint8_t low_{0xff};
-    std::uint8_t high_{0xff};
-  };
-  [[nodiscard]] RegPair &reg_for(R8 r8);
-  [[nodiscard]] const RegPair &reg_for(R8 r8) const;
-  [[nodiscard]] RegPair &reg_for(R16 r16);
-  [[nodiscard]] const RegPair &reg_for(R16 r16) const;
+  [[nodiscard]] constexpr std::uint16_t load16(const std::size_t offset) const {
+    if consteval {
+      const auto first = bytes_[offset];
+      const auto second = bytes_[offset + 1];
+      return little_endian ? static_cast<std::uint16_t>(second << 8 | first)
+                           : static_cast<std::uint16_t>(first << 8 | second);
+    }
+    else {
+      std::uint16_t value{};
+      std::memcpy(&value, &bytes_[offset], sizeof(value));
+      return value;
+    }
+  }
+  constexpr void store16(const std::size_t offset, const std::uint16_t value) {
+    if consteval {
+      const auto high = static_cast<std::uint8_t>(value >> 8);
+      const auto low = static_cast<std::uint8_t>(value);
+      bytes_[offset] = little_endian ? low : high;
+      bytes_[offset + 1] = little_endian ? high : low;
+    }
+    else {
+      std::memcpy(&bytes_[offset], &value, sizeof(value));
+    }
+  }
 
-  std::array<RegPair, 11> regs_{};
+  // "The Undocumented Z80 Documented" has the paired registers power up as all ones.
+  std::array<std::uint8_t, NumPairs * 2> bytes_ = [] {
+    std::array<std::uint8_t, NumPairs * 2> bytes{};
+    bytes.fill(0xff);
+    return bytes;
+  }();
   std::uint16_t wz_{0xffff};
   std::uint16_t pc_{};
   std::uint8_t r_{};
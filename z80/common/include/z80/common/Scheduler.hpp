@@ -60,11 +60,29 @@ public:
   [[nodiscard]] auto cycles() const { return cycles_; }
 
 private:
-  std::size_t cycles_ = 0;
   struct ScheduledTask {
     std::size_t cycle{};
     Task *task{};
   };
+
+public:
+  // The time and the queue of due tasks, held by address: only valid for this scheduler while those tasks live.
+  struct Checkpoint {
+    std::size_t cycles{};
+    std::vector<ScheduledTask> tasks;
+  };
+  [[nodiscard]] Checkpoint checkpoint() const { return {cycles_, tasks_}; }
+  void restore(const Checkpoint &checkpoint) {
+    for (const auto &scheduled: tasks_)
+      scheduled.task->scheduled_ = false;
+    cycles_ = checkpoint.cycles;
+    tasks_ = checkpoint.tasks;
+    for (const auto &scheduled: tasks_)
+      scheduled.task->scheduled_ = true;
+  }
+
+private:
+  std::size_t cycles_ = 0;
   std::vector<ScheduledTask> tasks_;
 };
 
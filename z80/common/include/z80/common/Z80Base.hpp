@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
 #include <vector>
 #endif
 
@@ -41,6 +42,7 @@ public:
   void irq_mode(const std::uint8_t mode) { irq_mode_ = mode; }
   [[nodiscard]] std::uint8_t irq_mode() const { return irq_mode_; };
   void interrupt() { irq_pending_ = true; }
+  [[nodiscard]] bool interrupt_pending() const { return irq_pending_; }
 
   [[nodiscard]] Flags flags() const;
   void flags(Flags flags);
@@ -59,9 +61,62 @@ public:
 
   void halt();
   [[nodiscard]] bool halted() const { return halted_; }
+  // A halted CPU executes NOPs until interrupted. Nothing can wake it before the next scheduled task, so this skips
+  // straight there in whole 4 T-state NOPs, refreshing R once for each.
+  void pass_halted_time();
 
   void pass_time(const std::size_t tstates) { scheduler_.tick(tstates); }
 
+  // Everything about the CPU that execution depends on, bar time (which the scheduler keeps) and memory.
+  struct Checkpoint {
+    RegisterFile regs;
+    bool halted{};
+    bool irq_pending{};
+    bool iff1{};
+    bool iff2{};
+    std::uint8_t irq_mode{};
+    std::size_t contended_accesses{};
+  };
+  [[nodiscard]] Checkpoint checkpoint() const {
+    return {regs_, halted_, irq_pending_, iff1_, iff2_, irq_mode_, contended_accesses_};
+  }
+  void restore(const Checkpoint &checkpoint) {
+    regs_ = checkpoint.regs;
+    halted_ = checkpoint.halted;
+    irq_pending_ = checkpoint.irq_pending;
+    iff1_ = checkpoint.iff1;
+    iff2_ = checkpoint.iff2;
+    irq_mode_ = checkpoint.irq_mode;
+    contended_accesses_ = checkpoint.contended_accesses;
+  }
+
+  // ULA contention: how long the CPU is held at each T-state of the frame, indexed by cycle count modulo its size, when
+  // it accesses contended memory. Empty (the default) for none.
+  void contention(const std::span<const std::uint8_t> delays) { contention_ = delays; }
+  // Only a core that calls contend() for every fetch, read and write is timed by the table; the others hide this.
+  static constexpr bool ContendsAccesses = false;
+  [[nodiscard]] bool subject_to_contention(const std::uint16_t address) const {
+    return !contention_.empty() && memory_.contended(address);
+  }
+  void contend(const std::uint16_t address) {
+    if (subject_to_contention(address)) [[unlikely]] {
+      ++contended_accesses_;
+      pass_time(contention_[scheduler_.cycles() % contention_.size()]);
+    }
+  }
+  // Counts accesses that may have been delayed, so callers can tell whether some stretch of code ran at a fixed speed.
+  [[nodiscard]] std::size_t contended_accesses() const { return contended_accesses_; }
+
+  // The repeating block instructions rewind PC after every byte. When accelerated, the repeats that fit before the next
+  // scheduled task are done in bulk instead, with exactly the same outcome as stepping through them.
+  void accelerate_block_ops(const bool accelerate) { accelerate_block_ops_ = accelerate; }
+
+  // Called by LDIR/LDDR and CPIR/CPDR after their opcode fetch. Performs the repeats that can safely be done in bulk,
+  // leaving memory, registers, R, WZ and time as stepping would just after fetching the next iteration. The caller then
+  // executes that iteration normally, which sets the flags and decides whether to repeat again.
+  void bulk_block_load(bool increment);
+  void bulk_block_compare(bool increment);
+
 protected:
   RegisterFile regs_;
   Scheduler &scheduler_;
@@ -71,8 +126,15 @@ protected:
   bool iff1_{};
   bool iff2_{};
   std::uint8_t irq_mode_{};
+  bool accelerate_block_ops_{};
+  std::span<const std::uint8_t> contention_{};
+  std::size_t contended_accesses_{};
   std::vector<InHandler> in_handlers_;
   std::vector<OutHandler> out_handlers_;
+
+private:
+  [[nodiscard]] std::size_t bulk_repeats_available() const;
+  void skip_repeats(std::size_t repeats, bool increment, bool moves_de);
 };
 
 } // namespace specbolt
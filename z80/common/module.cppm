@@ -2,6 +2,7 @@ export module z80_common;
 
 export import :Alu;
 export import :Flags;
+export import :LazyFlags;
 export import :RegisterFile;
 export import :Scheduler;
 export import :Z80Base;
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_tostring.hpp>
 
+#include <cstdint>
 #include <format>
 
 #ifdef SPECBOLT_MODULES
@@ -291,4 +292,82 @@ TEST_CASE("ALU tests") {
   // }
 }
 
+namespace {
+
+// Straightforward arithmetic versions of the flag calculations, to check the lookup tables against.
+Flags reference_sz53(const std::uint8_t value) {
+  return (Flags(value) & (Flags::Sign() | Flags::Flag3() | Flags::Flag5())) | (value == 0 ? Flags::Zero() : Flags());
+}
+
+Flags reference_parity(const std::uint8_t value) {
+  auto bits = 0;
+  for (auto bit = 0; bit < 8; ++bit)
+    bits += (value >> bit) & 1;
+  return bits % 2 == 0 ? Flags::Parity() : Flags();
+}
+
+Alu::R8 reference_add8(const std::uint8_t lhs, const std::uint8_t rhs, const bool carry_in) {
+  const auto carry = carry_in ? 1 : 0;
+  const auto result = static_cast<std::uint8_t>(lhs + rhs + carry);
+  const auto signed_result = static_cast<std::int8_t>(lhs) + static_cast<std::int8_t>(rhs) + carry;
+  return {result, reference_sz53(result) | (lhs + rhs + carry > 0xff ? Flags::Carry() : Flags()) |
+                      ((lhs & 0xf) + (rhs & 0xf) + carry > 0xf ? Flags::HalfCarry() : Flags()) |
+                      (signed_result < -128 || signed_result > 127 ? Flags::Overflow() : Flags())};
+}
+
+Alu::R8 reference_sub8(const std::uint8_t lhs, const std::uint8_t rhs, const bool carry_in) {
+  const auto carry = carry_in ? 1 : 0;
+  const auto result = static_cast<std::uint8_t>(lhs - rhs - carry);
+  const auto signed_result = static_cast<std::int8_t>(lhs) - static_cast<std::int8_t>(rhs) - carry;
+  return {result, reference_sz53(result) | Flags::Subtract() | (lhs - rhs - carry < 0 ? Flags::Carry() : Flags()) |
+                      ((lhs & 0xf) - (rhs & 0xf) - carry < 0 ? Flags::HalfCarry() : Flags()) |
+                      (signed_result < -128 || signed_result > 127 ? Flags::Overflow() : Flags())};
+}
+
+} // namespace
+
+TEST_CASE("ALU flag tables") {
+  SECTION("sz53 and parity by value") {
+    for (auto value = 0u; value < 0x100; ++value) {
+      INFO(std::format("value: {:02x}", value));
+      const auto byte = static_cast<std::uint8_t>(value);
+      CHECK(Alu::sz53_table[value] == reference_sz53(byte));
+      CHECK(Alu::sz53p_table[value] == (reference_sz53(byte) | reference_parity(byte)));
+      CHECK(Alu::parity_flags_for(byte) == (reference_sz53(byte) | reference_parity(byte)));
+    }
+  }
+  SECTION("inc and dec") {
+    for (auto value = 0u; value < 0x100; ++value) {
+      INFO(std::format("value: {:02x}", value));
+      const auto byte = static_cast<std::uint8_t>(value);
+      for (const auto carry: {Flags(), Flags::Carry()}) {
+        const auto inc = reference_add8(byte, 1, false);
+        const auto dec = reference_sub8(byte, 1, false);
+        CHECK(Alu::inc8(byte, carry) == Alu::R8{inc.result, (inc.flags & ~Flags::Carry()) | carry});
+        CHECK(Alu::dec8(byte, carry) == Alu::R8{dec.result, (dec.flags & ~Flags::Carry()) | carry});
+      }
+    }
+  }
+  SECTION("add and subtract, every operand and carry") {
+    // Checking everything and reporting only the first failure keeps the output manageable if something breaks.
+    auto failures = 0uz;
+    for (auto lhs = 0u; lhs < 0x100 && failures == 0; ++lhs) {
+      for (auto rhs = 0u; rhs < 0x100 && failures == 0; ++rhs) {
+        for (const auto carry_in: {false, true}) {
+          const auto l = static_cast<std::uint8_t>(lhs);
+          const auto r = static_cast<std::uint8_t>(rhs);
+          if (Alu::add8(l, r, carry_in) != reference_add8(l, r, carry_in) ||
+              Alu::sub8(l, r, carry_in) != reference_sub8(l, r, carry_in)) {
+            INFO(std::format("lhs: {:02x} rhs: {:02x} carry: {}", lhs, rhs, carry_in));
+            CHECK(Alu::add8(l, r, carry_in) == reference_add8(l, r, carry_in));
+            CHECK(Alu::sub8(l, r, carry_in) == reference_sub8(l, r, carry_in));
+            ++failures;
+          }
+        }
+      }
+    }
+    CHECK(failures == 0);
+  }
+}
+
 } // namespace specbolt
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <format>
+
+#ifdef SPECBOLT_MODULES
+import z80_common;
+#else
+#include "z80/common/Alu.hpp"
+#include "z80/common/LazyFlags.hpp"
+#endif
+
+namespace specbolt {
+
+namespace {
+
+template<LazyFlags::Op op>
+void check_against_eager(const auto eager) {
+  for (auto lhs = 0u; lhs < 0x100; ++lhs) {
+    for (auto rhs = 0u; rhs < 0x100; ++rhs) {
+      for (const auto carry_in: {false, true}) {
+        LazyFlags lazy;
+        const auto result =
+            lazy.defer<op>(static_cast<std::uint8_t>(lhs), static_cast<std::uint8_t>(rhs), carry_in);
+        const Alu::R8 expected = eager(static_cast<std::uint8_t>(lhs), static_cast<std::uint8_t>(rhs), carry_in);
+        // Only report the first mismatch; there are a lot of cases.
+        if (result != expected.result || lazy.evaluate() != expected.flags || lazy.zero() != expected.flags.zero() ||
+            lazy.sign() != expected.flags.sign() || lazy.carry() != expected.flags.carry() ||
+            lazy.parity() != expected.flags.parity()) {
+          INFO(std::format("lhs: {:02x} rhs: {:02x} carry: {}", lhs, rhs, carry_in));
+          CHECK(result == expected.result);
+          CHECK(lazy.evaluate().to_string() == expected.flags.to_string());
+          CHECK(lazy.zero() == expected.flags.zero());
+          CHECK(lazy.sign() == expected.flags.sign());
+          CHECK(lazy.carry() == expected.flags.carry());
+          CHECK(lazy.parity() == expected.flags.parity());
+          return;
+        }
+      }
+    }
+  }
+  SUCCEED();
+}
+
+} // namespace
+
+TEST_CASE("Lazy flags match the eager ALU") {
+  SECTION("add") {
+    check_against_eager<LazyFlags::Op::Add8>([](const auto lhs, const auto rhs, const bool carry_in) {
+      return Alu::add8(lhs, rhs, carry_in);
+    });
+  }
+  SECTION("sub") {
+    check_against_eager<LazyFlags::Op::Sub8>([](const auto lhs, const auto rhs, const bool carry_in) {
+      return Alu::sub8(lhs, rhs, carry_in);
+    });
+  }
+  SECTION("cp") {
+    check_against_eager<LazyFlags::Op::Cmp8>(
+        [](const auto lhs, const auto rhs, bool) { return Alu::cmp8(lhs, rhs); });
+  }
+  SECTION("and") {
+    check_against_eager<LazyFlags::Op::And8>(
+        [](const auto lhs, const auto rhs, bool) { return Alu::and8(lhs, rhs); });
+  }
+  SECTION("xor") {
+    check_against_eager<LazyFlags::Op::Xor8>(
+        [](const auto lhs, const auto rhs, bool) { return Alu::xor8(lhs, rhs); });
+  }
+  SECTION("or") {
+    check_against_eager<LazyFlags::Op::Or8>([](const auto lhs, const auto rhs, bool) { return Alu::or8(lhs, rhs); });
+  }
+  SECTION("inc") {
+    check_against_eager<LazyFlags::Op::Inc8>([](const auto lhs, auto, const bool carry_in) {
+      return Alu::inc8(lhs, carry_in ? Flags::Carry() : Flags());
+    });
+  }
+  SECTION("dec") {
+    check_against_eager<LazyFlags::Op::Dec8>([](const auto lhs, auto, const bool carry_in) {
+      return Alu::dec8(lhs, carry_in ? Flags::Carry() : Flags());
+    });
+  }
+}
+
+TEST_CASE("Lazy flags start and end idle") {
+  LazyFlags lazy;
+  CHECK(!lazy.pending());
+  lazy.defer<LazyFlags::Op::Add8>(1, 2, false);
+  CHECK(lazy.pending());
+  lazy.clear();
+  CHECK(!lazy.pending());
+}
+
+} // namespace specbolt
@@ -78,3 +78,18 @@ TEST_CASE("RegisterFile tests") {
     }
   }
 }
+
+TEST_CASE("RegisterFile is usable at compile time") {
+  STATIC_CHECK([] {
+    RegisterFile rf;
+    rf.set(RegisterFile::R16::BC, 0x1234);
+    return rf.get(RegisterFile::R8::B) == 0x12 && rf.get(RegisterFile::R8::C) == 0x34;
+  }());
+  STATIC_CHECK([] {
+    RegisterFile rf;
+    rf.set(RegisterFile::R8::H, 0x12);
+    rf.set(RegisterFile::R8::L, 0x34);
+    rf.ex(RegisterFile::R16::DE, RegisterFile::R16::HL);
+    return rf.get(RegisterFile::R16::DE) == 0x1234 && rf.get(RegisterFile::R16::HL) == 0xffff;
+  }());
+}
@@ -1,8 +1,12 @@
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <algorithm>
 #include <cstdint>
+#include <format>
 #include <ranges>
+#include <tuple>
+#include <vector>
 
 #ifdef SPECBOLT_MODULES
 import z80_v1;
@@ -645,6 +649,14 @@ struct OpcodeTester {
       }
       // todo ... consider testing the others though honestly...
     }
+    SECTION("rst 0x38") {
+      regs.sp(0x0000);
+      run(0xff); // rst 0x38
+      CHECK(z80.pc() == 0x38);
+      CHECK(z80.cycle_count() == 11);
+      CHECK(memory.read16(0xfffe) == 0x0001);
+      CHECK(regs.sp() == 0xfffe);
+    }
     SECTION("pop bc") {
       regs.sp(0xfffd);
       memory.write16(0xfffd, 0xbab1);
@@ -1485,8 +1497,154 @@ struct OpcodeTester {
       }
     }
   }
+
+  void self_modifying() {
+    SECTION("sees writes to already-executed code") {
+      run(0x3e, 0x12); // ld a, 0x12
+      CHECK(regs.get(RegisterFile::R8::A) == 0x12);
+      regs.pc(0);
+      run(0x3e, 0x34); // ld a, 0x34
+      CHECK(regs.get(RegisterFile::R8::A) == 0x34);
+    }
+    SECTION("sees code overwrite an instruction it has already run") {
+      write_to_memory(memory, 0, 0x32, 0x04, 0x00, 0x00, 0x00); // ld (0x0004), a ; nop ; nop
+      regs.pc(4);
+      z80.execute_one();
+      regs.pc(0);
+      regs.set(RegisterFile::R8::A, 0x3c); // inc a
+      z80.execute_one();
+      z80.execute_one();
+      z80.execute_one();
+      CHECK(regs.get(RegisterFile::R8::A) == 0x3d);
+      CHECK(z80.pc() == 5);
+    }
+    SECTION("sees paging changes") {
+      run(0x3e, 0x11); // ld a, 0x11
+      CHECK(regs.get(RegisterFile::R8::A) == 0x11);
+      memory.raw_write(1, 0, 0x3e);
+      memory.raw_write(1, 1, 0x22);
+      memory.set_page_table({1, 0, 2, 3});
+      regs.pc(0);
+      z80.execute_one();
+      CHECK(regs.get(RegisterFile::R8::A) == 0x22);
+    }
+  }
 };
 
+namespace {
+
+template<typename DUT>
+struct BlockOpMachine {
+  struct Snoop final : Scheduler::Task {
+    const DUT &z80;
+    RegisterFile seen{};
+    explicit Snoop(const DUT &z80) : z80(z80) {}
+    void run(std::size_t) override { seen = z80.regs(); }
+  };
+
+  Scheduler scheduler;
+  Memory memory{4};
+  DUT z80{scheduler, memory};
+  Snoop snoop{z80};
+
+  BlockOpMachine(const bool accelerate, const std::uint8_t opcode, const std::uint16_t hl, const std::uint16_t de,
+      const std::uint16_t bc, const std::uint8_t a) {
+    memory.set_rom_flags({false, false, false, false});
+    for (auto address = 0x4000u; address < 0x10000u; ++address)
+      memory.write(static_cast<std::uint16_t>(address), static_cast<std::uint8_t>(address * 7 ^ address >> 8));
+    write_to_memory(memory, 0, 0xed, opcode, 0x76);
+    memory.set_rom_flags({false, false, false, true});
+    z80.accelerate_block_ops(accelerate);
+    z80.regs().set(RegisterFile::R16::HL, hl);
+    z80.regs().set(RegisterFile::R16::DE, de);
+    z80.regs().set(RegisterFile::R16::BC, bc);
+    z80.regs().set(RegisterFile::R8::A, a);
+    scheduler.schedule(snoop, 5000);
+    while (!z80.halted())
+      z80.execute_one();
+  }
+};
+
+void check_same_regs(const RegisterFile &lhs, const RegisterFile &rhs) {
+  for (const auto r16: {RegisterFile::R16::AF, RegisterFile::R16::BC, RegisterFile::R16::DE, RegisterFile::R16::HL})
+    CHECK(lhs.get(r16) == rhs.get(r16));
+  CHECK(lhs.pc() == rhs.pc());
+  CHECK(lhs.wz() == rhs.wz());
+  CHECK(lhs.r() == rhs.r());
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("Accelerated block ops match stepping", "[opcode]", v2::Z80, v3::Z80) {
+  using Case = std::tuple<std::uint8_t, std::uint16_t, std::uint16_t, std::uint16_t, std::uint8_t>;
+  const auto [opcode, hl, de, bc, a] = GENERATE(values<Case>({
+      {0xb0, 0x8000, 0x9000, 0x0300, 0x00}, // ldir
+      {0xb0, 0x8000, 0x8001, 0x0200, 0x00}, // ldir filling as it goes
+      {0xb0, 0x7f00, 0xbf80, 0x0400, 0x00}, // ldir across page boundaries
+      {0xb0, 0x8000, 0xbf00, 0x0200, 0x00}, // ldir into ROM
+      {0xb8, 0x9fff, 0xafff, 0x0300, 0x00}, // lddr
+      {0xb8, 0x9001, 0x9000, 0x0200, 0x00}, // lddr filling as it goes
+      {0xb1, 0x8000, 0x0000, 0x1000, 0xaa}, // cpir
+      {0xb1, 0x8000, 0x0000, 0x0000, 0x3c}, // cpir with bc = 0
+      {0xb9, 0xbfff, 0x0000, 0x1000, 0x55}, // cpdr
+  }));
+  INFO(std::format("ed {:02x} hl={:04x} de={:04x} bc={:04x} a={:02x}", opcode, hl, de, bc, a));
+  const BlockOpMachine<TestType> stepped{false, opcode, hl, de, bc, a};
+  const BlockOpMachine<TestType> accelerated{true, opcode, hl, de, bc, a};
+  CHECK(stepped.z80.cycle_count() == accelerated.z80.cycle_count());
+  check_same_regs(stepped.z80.regs(), accelerated.z80.regs());
+  check_same_regs(stepped.snoop.seen, accelerated.snoop.seen);
+  for (std::uint8_t page = 0; page < 4; ++page)
+    CHECK(std::ranges::equal(stepped.memory.page_data(page), accelerated.memory.page_data(page)));
+}
+
+TEMPLATE_TEST_CASE_METHOD(
+    OpcodeTester, "Self-modifying code", "[opcode]", v1::Z80, v2::Z80, v3::Z80) {
+  OpcodeTester<TestType>::self_modifying();
+}
+
+TEMPLATE_TEST_CASE_METHOD(
+    OpcodeTester, "Halted execution skips to the next scheduled task", "[opcode]", v1::Z80, v2::Z80, v3::Z80) {
+  struct Wake final : Scheduler::Task {
+    void run(std::size_t) override {}
+  } wake;
+  const auto refreshed = [](const std::uint8_t r, const std::size_t by) {
+    return static_cast<std::uint8_t>((r & 0x80) | ((r + by) & 0x7f));
+  };
+  this->run(0x76); // halt
+  const auto r = this->regs.r();
+  this->scheduler.schedule(wake, 1001);
+  this->z80.execute_one();
+  // 251 NOPs reach the task, the last one finishing just after it.
+  CHECK(this->z80.cycle_count() == 4 + 251 * 4);
+  CHECK(this->regs.r() == refreshed(r, 251));
+  CHECK(this->z80.halted());
+  this->z80.execute_one();
+  // With nothing left to wait for it's one NOP at a time.
+  CHECK(this->z80.cycle_count() == 4 + 252 * 4);
+  CHECK(this->regs.r() == refreshed(r, 252));
+}
+
+TEMPLATE_TEST_CASE_METHOD(OpcodeTester, "Contended accesses are held up", "[opcode]", v2::Z80, v3::Z80) {
+  const std::vector<std::uint8_t> delays(64, 2);
+  this->memory.set_contended_pages(1u << 1);
+  this->z80.contention(delays);
+  SECTION("uncontended") {
+    this->run(0x3a, 0x00, 0x80); // ld a, (0x8000)
+    CHECK(this->z80.cycle_count() == 13);
+  }
+  SECTION("contended") {
+    this->run(0x3a, 0x00, 0x40); // ld a, (0x4000)
+    CHECK(this->z80.cycle_count() == 15);
+    CHECK(this->z80.contended_accesses() == 1);
+  }
+  SECTION("contended opcode fetch") {
+    this->regs.pc(0x4000);
+    this->run(0x00); // nop
+    CHECK(this->z80.cycle_count() == 6);
+  }
+}
+
 TEMPLATE_TEST_CASE_METHOD(
     OpcodeTester, "Unprefixed opcode execution tests", "[opcode][generated]", v1::Z80, v2::Z80, v3::Z80) {
   OpcodeTester<TestType>::unprefixed();
@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef SPECBOLT_MODULES
+import z80_v1;
+import z80_v2;
+import z80_v3;
+import z80_common;
+#else
+#include "z80/v1/Disassembler.hpp"
+#include "z80/v1/Z80.hpp"
+#include "z80/v2/Z80.hpp"
+#include "z80/v3/Z80.hpp"
+#endif
+
+#include <lyra/lyra.hpp>
+
+#ifdef SPECBOLT_MODULES
+import peripherals;
+#else
+#include "peripherals/Memory.hpp"
+#include "z80/common/Flags.hpp"
+#include "z80/common/Scheduler.hpp"
+#endif
+
+namespace specbolt {
+
+namespace {
+
+constexpr auto AddressSpace = 0x10000uz;
+
+// Everything needed to start a run: the same state is loaded into every core.
+struct State {
+  RegisterFile regs;
+  bool iff1{};
+  bool iff2{};
+  std::uint8_t irq_mode{};
+  std::vector<std::uint8_t> memory = std::vector<std::uint8_t>(AddressSpace);
+};
+
+// Turns off v1's decode cache, which like the other fast paths only runs when nobody is listening.
+class Unobserved final : public Memory::Listener {
+public:
+  void on_memory_read(std::uint16_t) override {}
+  void on_memory_write(std::uint16_t) override {}
+};
+
+template<typename DUT>
+struct Core {
+  std::string_view name;
+  // Run a block at a time where the core can, and the repeating block instructions in bulk.
+  bool fast{};
+  Scheduler scheduler;
+  Memory memory{4};
+  // Memory as loaded. Only the blocks each case writes differ from it, so undoing a case restores just those.
+  Memory::Checkpoint loaded;
+  // Kept from case to case, so its caches of decoded code see memory change under them.
+  std::optional<DUT> z80;
+  std::size_t start_cycles{};
+  std::uint64_t start_stamp{};
+  // False while the core has run ahead of the reference, e.g. through a block or a bulk copy.
+  bool synced{true};
+
+  explicit Core(const std::string_view name_, Memory::Listener *listener = nullptr) : name(name_) {
+    memory.set_rom_flags({false, false, false, false});
+    memory.set_listener(listener);
+  }
+
+  void load_memory(const std::vector<std::uint8_t> &bytes) {
+    for (auto address = 0uz; address < bytes.size(); ++address)
+      memory.raw_write(static_cast<std::uint16_t>(address), bytes[address]);
+    loaded = memory.checkpoint();
+  }
+
+  void undo() {
+    memory.restore(loaded);
+    memory.checkpoint(loaded);
+  }
+
+  void start(const State &state) {
+    if (!z80)
+      z80.emplace(scheduler, memory);
+    // Restoring is the only way out of a HALT.
+    z80->restore({.regs = state.regs, .iff1 = state.iff1, .iff2 = state.iff2, .irq_mode = state.irq_mode});
+    z80->accelerate_block_ops(fast);
+    start_cycles = scheduler.cycles();
+    start_stamp = memory.write_stamp();
+    synced = true;
+  }
+
+  // Returns false if the core doesn't support the instruction.
+  bool step() {
+    try {
+      if constexpr (requires { z80->execute_block(0uz); }) {
+        if (fast) {
+          z80->execute_block(std::numeric_limits<std::size_t>::max());
+          return true;
+        }
+      }
+      z80->execute_one();
+      return true;
+    }
+    catch (...) {
+      return false;
+    }
+  }
+
+  // Blocks of physical memory written since the case started.
+  [[nodiscard]] bool written(const std::size_t block) const {
+    return memory.block_write_stamp(block * Memory::WriteBlockSize) > start_stamp;
+  }
+};
+
+struct Observation {
+  RegisterFile regs;
+  bool halted{};
+  bool iff1{};
+  bool iff2{};
+  std::uint8_t irq_mode{};
+  // Since the case started, so cores that have run different numbers of steps can be compared.
+  std::size_t cycles{};
+};
+
+template<typename DUT>
+Observation observe(const Core<DUT> &core) {
+  return {core.z80->regs(), core.z80->halted(), core.z80->iff1(), core.z80->iff2(), core.z80->irq_mode(),
+      core.scheduler.cycles() - core.start_cycles};
+}
+
+// Describes the first byte that differs between two cores' memories, or returns nothing if they agree. Both started
+// the case with the same memory, so only blocks that one or other has written since need comparing.
+template<typename Ref, typename DUT>
+std::string memory_difference(const Core<Ref> &ref, const Core<DUT> &other) {
+  if (ref.memory.write_stamp() == ref.start_stamp && other.memory.write_stamp() == other.start_stamp)
+    return {};
+  for (auto block = 0uz; block < AddressSpace / Memory::WriteBlockSize; ++block) {
+    if (!ref.written(block) && !other.written(block))
+      continue;
+    for (auto address = block * Memory::WriteBlockSize; address < (block + 1) * Memory::WriteBlockSize; ++address) {
+      const auto lhs = ref.memory.peek(static_cast<std::uint16_t>(address));
+      const auto rhs = other.memory.peek(static_cast<std::uint16_t>(address));
+      if (lhs != rhs)
+        return std::format(" memory at {:04x}: {:02x} vs {:02x};", address, lhs, rhs);
+    }
+  }
+  return {};
+}
+
+struct Fuzzer {
+  std::uint64_t seed{std::random_device{}()};
+  std::size_t num_cases{100'000};
+  std::size_t length{16};
+  std::size_t batch_size{1024};
+  bool exact{};
+  bool fast_paths{};
+  bool v1_vs_v2{};
+  bool need_help{};
+
+  // v2, one instruction at a time, is the reference the others must agree with. v1 doesn't yet agree with it on R, the
+  // timing of many prefixed instructions and a few flags, so by default v1 is only checked against itself with its
+  // decode cache turned off.
+  Unobserved unobserved;
+  Core<v2::Z80> v2{"v2"};
+  Core<v3::Z80> v3{"v3"};
+  Core<v2::Z80> v2_blocks{"v2 (blocks)"};
+  Core<v1::Z80> v1{"v1"};
+  Core<v1::Z80> v1_uncached{"v1 (uncached)", &unobserved};
+
+  std::size_t instructions_run{};
+  std::size_t unsupported{};
+
+  void for_each_core(auto &&func) {
+    func(v2);
+    func(v3);
+    if (fast_paths)
+      func(v2_blocks);
+    func(v1);
+    func(v1_uncached);
+  }
+
+  // Describes how two observations differ, or returns nothing if they agree.
+  [[nodiscard]] std::string compare(const Observation &ref, const Observation &other) const {
+    using R16 = RegisterFile::R16;
+    std::string result;
+    const auto check = [&](const std::string_view what, const auto lhs, const auto rhs) {
+      if (lhs != rhs)
+        result += std::format(" {}: {:x} vs {:x};", what, lhs, rhs);
+    };
+    // By default, ignore the undocumented flags, bit 7 of R and WZ, none of which all the cores agree on yet.
+    const auto af_mask = exact ? 0xffff : (0xff00 | ~(Flags::Flag3() | Flags::Flag5()).to_u8());
+    check("AF", ref.regs.get(R16::AF) & af_mask, other.regs.get(R16::AF) & af_mask);
+    check("AF'", ref.regs.get(R16::AF_) & af_mask, other.regs.get(R16::AF_) & af_mask);
+    static constexpr std::array<std::pair<R16, std::string_view>, 9> Named{{{R16::BC, "BC"}, {R16::DE, "DE"},
+        {R16::HL, "HL"}, {R16::BC_, "BC'"}, {R16::DE_, "DE'"}, {R16::HL_, "HL'"}, {R16::SP, "SP"}, {R16::IX, "IX"},
+        {R16::IY, "IY"}}};
+    for (const auto &[r16, name]: Named)
+      check(name, ref.regs.get(r16), other.regs.get(r16));
+    check("PC", ref.regs.pc(), other.regs.pc());
+    check("I", ref.regs.i(), other.regs.i());
+    check("R", ref.regs.r() & (exact ? 0xff : 0x7f), other.regs.r() & (exact ? 0xff : 0x7f));
+    if (exact)
+      check("WZ", ref.regs.wz(), other.regs.wz());
+    check("halted", ref.halted, other.halted);
+    check("iff1", ref.iff1, other.iff1);
+    check("iff2", ref.iff2, other.iff2);
+    check("im", ref.irq_mode, other.irq_mode);
+    check("T-states", ref.cycles, other.cycles);
+    return result;
+  }
+
+  struct Divergence {
+    std::size_t instruction{};
+    std::string description;
+  };
+
+  // Runs up to max_instructions on the reference cores from their current state, comparing the others after each one.
+  // A core that runs ahead, through a block or a bulk copy, is compared once the reference has caught up with it.
+  std::optional<Divergence> run_lockstep(const std::size_t max_instructions) {
+    // Enough for a bulk copy of all 64K to be caught up with, one repeat at a time.
+    constexpr auto MaxCatchUp = 0x10000uz;
+    bool catching_up = false;
+    for (auto instruction = 0uz;
+        instruction < max_instructions || (catching_up && instruction < max_instructions + MaxCatchUp); ++instruction) {
+      if (!v2.step() || !v1_uncached.step()) {
+        ++unsupported;
+        return std::nullopt;
+      }
+      const auto expected = observe(v2);
+      const auto expected_v1 = observe(v1_uncached);
+      bool all_supported = true;
+      catching_up = false;
+      std::string description;
+      const auto check = [&](const auto &ref, const auto &core, const Observation &ref_observation) {
+        if (const auto diff = compare(ref_observation, observe(core)) + memory_difference(ref, core); !diff.empty())
+          description += std::format("{}{} vs {}:{}", description.empty() ? "" : "\n", ref.name, core.name, diff);
+      };
+      const auto follow = [&](const auto &ref, auto &core, const Observation &ref_observation) {
+        if (core.synced)
+          all_supported &= core.step();
+        // Nothing runs past a HALT, so being ahead of a halted reference is a divergence in itself.
+        core.synced = observe(core).cycles <= ref_observation.cycles || ref_observation.halted;
+        if (core.synced)
+          check(ref, core, ref_observation);
+        else
+          catching_up = true;
+      };
+      follow(v2, v3, expected);
+      if (fast_paths)
+        follow(v2, v2_blocks, expected);
+      follow(v1_uncached, v1, expected_v1);
+      if (v1_vs_v2)
+        check(v2, v1_uncached, expected);
+      if (!all_supported) {
+        ++unsupported;
+        return std::nullopt;
+      }
+      ++instructions_run;
+      if (!description.empty())
+        return Divergence{instruction, description};
+      if (expected.halted)
+        break;
+    }
+    return std::nullopt;
+  }
+
+  // Loads a complete state into every core. Slow, so only used when shrinking.
+  std::optional<Divergence> run_from(const State &state, const std::size_t max_instructions) {
+    for_each_core([&](auto &core) {
+      core.load_memory(state.memory);
+      core.start(state);
+    });
+    return run_lockstep(max_instructions);
+  }
+
+  // Replays the state on v2 alone for some instructions, returning the state it reaches.
+  State advance(const State &state, const std::size_t instructions) {
+    v2.load_memory(state.memory);
+    v2.start(state);
+    for (auto i = 0uz; i < instructions; ++i)
+      v2.step();
+    State result{v2.z80->regs(), v2.z80->iff1(), v2.z80->iff2(), v2.z80->irq_mode()};
+    for (auto address = 0uz; address < AddressSpace; ++address)
+      result.memory[address] = v2.memory.read(static_cast<std::uint16_t>(address));
+    v2.undo();
+    return result;
+  }
+
+  // Shrinks a failure to the shortest tail of the instruction sequence that still diverges, then zeroes as many
+  // registers as possible.
+  std::pair<State, Divergence> shrink(State state, Divergence divergence) {
+    for (auto skip = divergence.instruction; skip > 0; --skip) {
+      auto candidate = advance(state, skip);
+      if (const auto result = run_from(candidate, divergence.instruction - skip + 1)) {
+        state = std::move(candidate);
+        divergence = *result;
+        break;
+      }
+    }
+    using R16 = RegisterFile::R16;
+    for (const auto r16: {R16::AF_, R16::BC_, R16::DE_, R16::HL_, R16::IX, R16::IY, R16::BC, R16::DE, R16::HL}) {
+      auto candidate = state;
+      candidate.regs.set(r16, 0);
+      if (const auto result = run_from(candidate, divergence.instruction + 1)) {
+        state = std::move(candidate);
+        divergence = *result;
+      }
+    }
+    return {std::move(state), std::move(divergence)};
+  }
+
+  void report(const State &state, const Divergence &divergence) {
+    std::println("Divergence found (seed {}), minimal reproduction:", seed);
+    state.regs.dump(std::cout, "  ");
+    std::println("  iff1 {} iff2 {} im {}", state.iff1, state.iff2, state.irq_mode);
+    v2.load_memory(state.memory);
+    v2.start(state);
+    const v1::Disassembler dis{v2.memory};
+    for (auto i = 0uz; i <= divergence.instruction; ++i) {
+      const auto disassembled = dis.disassemble(v2.z80->pc());
+      const auto bytes = std::span(disassembled.bytes).first(disassembled.instruction.length);
+      std::println("  {:04x} {::02x} {}", disassembled.address, bytes, disassembled.to_string());
+      v2.step();
+    }
+    v2.undo();
+    std::println("{}", divergence.description);
+  }
+
+  int run() {
+    v3.fast = v2_blocks.fast = fast_paths;
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<std::uint32_t> byte(0, 0xff);
+    std::uniform_int_distribution<std::uint32_t> word(0, 0xffff);
+
+    State base;
+    std::vector<State> batch(batch_size);
+    std::vector<std::vector<std::uint8_t>> streams(batch_size);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (auto case_base = 0uz; case_base < num_cases; case_base += batch_size) {
+      // A fresh random address space per batch; each case then only lays down its instruction stream over it.
+      std::ranges::generate(base.memory, [&] { return static_cast<std::uint8_t>(byte(rng)); });
+      for_each_core([&](auto &core) { core.load_memory(base.memory); });
+      // The batch's cases start near each other, so each lays its stream over code the last left in the caches.
+      const auto window = word(rng);
+      for (auto i = 0uz; i < batch_size; ++i) {
+        auto &regs = batch[i].regs;
+        for (const auto r16: {RegisterFile::R16::AF, RegisterFile::R16::BC, RegisterFile::R16::DE,
+                 RegisterFile::R16::HL, RegisterFile::R16::AF_, RegisterFile::R16::BC_, RegisterFile::R16::DE_,
+                 RegisterFile::R16::HL_, RegisterFile::R16::SP, RegisterFile::R16::IX, RegisterFile::R16::IY})
+          regs.set(r16, static_cast<std::uint16_t>(word(rng)));
+        regs.pc(static_cast<std::uint16_t>(window + byte(rng)));
+        regs.wz(static_cast<std::uint16_t>(word(rng)));
+        regs.i(static_cast<std::uint8_t>(byte(rng)));
+        regs.r(static_cast<std::uint8_t>(byte(rng)));
+        batch[i].iff1 = batch[i].iff2 = (byte(rng) & 1) != 0;
+        batch[i].irq_mode = static_cast<std::uint8_t>(byte(rng) % 3);
+        // Up to four bytes per instruction.
+        streams[i].resize(length * 4);
+        std::ranges::generate(streams[i], [&] { return static_cast<std::uint8_t>(byte(rng)); });
+      }
+
+      for (auto i = 0uz; i < batch_size && case_base + i < num_cases; ++i) {
+        const auto &state = batch[i];
+        for_each_core([&](auto &core) {
+          for (auto offset = 0uz; offset < streams[i].size(); ++offset)
+            core.memory.write(static_cast<std::uint16_t>(state.regs.pc() + offset), streams[i][offset]);
+          core.start(state);
+        });
+        const auto divergence = run_lockstep(length);
+        for_each_core([](auto &core) { core.undo(); });
+        if (divergence) {
+          auto full_state = state;
+          full_state.memory = base.memory;
+          for (auto offset = 0uz; offset < streams[i].size(); ++offset)
+            full_state.memory[(state.regs.pc() + offset) % AddressSpace] = streams[i][offset];
+          const auto [minimal_state, minimal_divergence] = shrink(std::move(full_state), *divergence);
+          report(minimal_state, minimal_divergence);
+          return 1;
+        }
+      }
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::println("{} cases, {} instructions in lockstep ({:.2f}M/s), {} cases stopped at unsupported opcodes",
+        num_cases, instructions_run, static_cast<double>(instructions_run) / elapsed / 1'000'000, unsupported);
+    return 0;
+  }
+};
+
+} // namespace
+
+} // namespace specbolt
+
+int main(const int argc, const char **argv) try {
+  specbolt::Fuzzer fuzzer;
+  const auto cli = lyra::cli() //
+                   | lyra::help(fuzzer.need_help) //
+                   | lyra::opt(fuzzer.seed, "SEED")["--seed"]("Random seed") //
+                   | lyra::opt(fuzzer.num_cases, "NUM")["--cases"]("Number of random cases to run") //
+                   | lyra::opt(fuzzer.length, "NUM")["--length"]("Maximum instructions per case") //
+                   | lyra::opt(fuzzer.batch_size, "NUM")["--batch"]("Cases generated per batch") //
+                   | lyra::opt(fuzzer.exact)["--exact"]("Also compare undocumented flags, bit 7 of R and WZ") //
+                   | lyra::opt(fuzzer.fast_paths)["--fast-paths"]("Run blocks and bulk block ops where cores can") //
+                   | lyra::opt(fuzzer.v1_vs_v2)["--v1-vs-v2"]("Also compare v1 with v2");
+  if (const auto parse_result = cli.parse({argc, argv}); !parse_result) {
+    std::println(std::cerr, "Error in command line: {}", parse_result.message());
+    return 1;
+  }
+  if (fuzzer.need_help) {
+    std::cout << cli << '\n';
+    return 0;
+  }
+  if (fuzzer.batch_size == 0 || fuzzer.length == 0) {
+    std::println(std::cerr, "Batch size and length must be positive");
+    return 1;
+  }
+  return fuzzer.run();
+}
+catch (const std::exception &e) {
+  std::cerr << "Exception: " << e.what() << "\n";
+  return 1;
+}
@@ -586,7 +586,7 @@ Instruction decode(const std::array<std::uint8_t, 4> opcodes) {
     case 0xe7: return {"rst 0x20", 1, Op::Call, Operand::None, Operand::Const_32};
     case 0xef: return {"rst 0x28", 1, Op::Call, Operand::None, Operand::Const_40};
     case 0xf7: return {"rst 0x30", 1, Op::Call, Operand::None, Operand::Const_48};
-    case 0xff: return {"rst 0x38", 1, Op::Call, Operand::None, Operand::Const_52};
+    case 0xff: return {"rst 0x38", 1, Op::Call, Operand::None, Operand::Const_56};
     default: break;
   }
   return invalid;
@@ -94,7 +94,7 @@ std::string Disassembler::Disassembled::operand_name(
     case Instruction::Operand::Const_32: return "32";
     case Instruction::Operand::Const_40: return "40";
     case Instruction::Operand::Const_48: return "48";
-    case Instruction::Operand::Const_52: return "52";
+    case Instruction::Operand::Const_56: return "56";
     case Instruction::Operand::Const_ffff: return "0xffff";
   }
   return "??";
@@ -138,7 +138,7 @@ Instruction::Output Instruction::apply(const Input input, Z80 &cpu) const {
         cpu.regs().pc(input.rhs);
       }
       // horrid check for rst
-      if (rhs >= Operand::Const_0 && rhs <= Operand::Const_52)
+      if (rhs >= Operand::Const_0 && rhs <= Operand::Const_56)
         return {0, input.flags, 7};
 
       return {0, input.flags, static_cast<std::uint8_t>(taken ? 13 : 6)};
@@ -14,14 +14,13 @@ void Z80::execute_one() {
     handle_interrupt();
   }
   if (halted_) [[unlikely]] {
-    pass_time(1);
+    pass_halted_time();
     return;
   }
 
   regs_.r(regs_.r() + 1);
   const auto initial_pc = regs_.pc();
-  const std::array opcodes{read8(initial_pc), read8(initial_pc + 1), read8(initial_pc + 2), read8(initial_pc + 3)};
-  const auto decoded = impl::decode(opcodes);
+  const auto decoded = decode_at(initial_pc);
   pass_time(4);
   regs_.pc(initial_pc + decoded.length); // NOT RIGHT
   try {
@@ -34,6 +33,27 @@ void Z80::execute_one() {
   }
 }
 
+Instruction Z80::decode_at(const std::uint16_t address) {
+  const auto decode = [&] {
+    return impl::decode(std::array{read8(address), read8(address + 1), read8(address + 2), read8(address + 3)});
+  };
+  // Listeners expect to see every opcode fetch, so don't short-circuit them.
+  if (memory_.has_listener())
+    return decode();
+
+  const auto physical_address = memory_.physical_address(address);
+  auto &entry = decode_cache_[address % DecodeCacheSize];
+  if (entry.physical_address == physical_address && memory_.block_write_stamp(physical_address) <= entry.stamp)
+    return entry.instruction;
+
+  const auto stamp = memory_.write_stamp();
+  const auto decoded = decode();
+  // Only instructions wholly within one write block can be validated by a single stamp check.
+  if (physical_address % Memory::WriteBlockSize + decoded.length <= Memory::WriteBlockSize)
+    entry = {physical_address, stamp, decoded};
+  return decoded;
+}
+
 void Z80::branch(const std::int8_t offset) { regs_.pc(static_cast<std::uint16_t>(regs_.pc() + offset)); }
 
 std::uint16_t Z80::read(const Instruction::Operand operand, const std::int8_t index_offset) {
@@ -84,7 +104,7 @@ std::uint16_t Z80::read(const Instruction::Operand operand, const std::int8_t in
     case Instruction::Operand::Const_32: return 32;
     case Instruction::Operand::Const_40: return 40;
     case Instruction::Operand::Const_48: return 48;
-    case Instruction::Operand::Const_52: return 52;
+    case Instruction::Operand::Const_56: return 56;
     case Instruction::Operand::Const_ffff: return 0xffff;
     case Instruction::Operand::ByteImmediate: return read8(regs_.pc() - 1);
     case Instruction::Operand::ByteImmediate_A:
@@ -64,7 +64,7 @@ struct Instruction {
     Const_32,
     Const_40,
     Const_48,
-    Const_52,
+    Const_56,
     Const_ffff,
   };
   enum class Operation {
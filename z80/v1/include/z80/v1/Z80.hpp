@@ -39,6 +39,17 @@ public:
 private:
   void execute(const Instruction &instr);
   void handle_interrupt();
+  [[nodiscard]] Instruction decode_at(std::uint16_t address);
+
+  // Direct-mapped cache of decoded instructions, indexed by PC. Entries are validated against Memory's write stamps, so
+  // self-modifying code and paging are both handled.
+  struct CachedInstruction {
+    std::size_t physical_address{~0uz};
+    std::uint64_t stamp{};
+    Instruction instruction{};
+  };
+  static constexpr auto DecodeCacheSize = 1024uz;
+  std::vector<CachedInstruction> decode_cache_ = std::vector<CachedInstruction>(DecodeCacheSize);
 };
 
 } // namespace specbolt::v1
@@ -3,6 +3,7 @@
 #include "z80/v2/Z80Impl.hpp"
 
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #endif
 
@@ -13,7 +14,7 @@ void Z80::execute_one() {
     handle_interrupt();
   }
   if (halted_) [[unlikely]] {
-    pass_time(1);
+    pass_halted_time();
     return;
   }
 
@@ -21,20 +22,97 @@ void Z80::execute_one() {
   impl::table<impl::build_execute_hl>[opcode](*this);
 }
 
+void Z80::execute_block(const std::size_t until_cycle) {
+  // Listeners expect to see every opcode fetch, so don't short-circuit them.
+  if (irq_pending_ || halted_ || memory_.has_listener()) [[unlikely]] {
+    execute_one();
+    return;
+  }
+  const auto *block = block_at(regs_.pc());
+  if (!block) [[unlikely]] {
+    execute_one();
+    return;
+  }
+
+  auto seen_stamp = memory_.write_stamp();
+  for (const auto &entry: std::span(block->entries).first(block->length)) {
+    // Leave on anything execute_one() would have handled differently: a taken branch or repeating block instruction, a
+    // pending interrupt, or running out of time.
+    if (regs_.pc() != entry.pc || irq_pending_ || cycle_count() >= until_cycle)
+      return;
+    if (const auto stamp = memory_.write_stamp(); stamp != seen_stamp) {
+      if (!valid(*block))
+        return;
+      seen_stamp = stamp;
+    }
+    for (auto fetch = 0u; fetch < entry.fetches; ++fetch) {
+      // Same timing and side effects as read_opcode(), without the memory read.
+      contend(regs_.pc());
+      pass_time(3);
+      regs_.pc(regs_.pc() + 1);
+      refresh();
+    }
+    entry.execute(*this);
+  }
+}
+
+const Z80::Block *Z80::block_at(const std::uint16_t address) {
+  const auto physical_start = memory_.physical_address(address);
+  auto &block = block_cache_[address % BlockCacheSize];
+  const auto last_address = static_cast<std::uint16_t>(address + (block.physical_end - block.physical_start) - 1);
+  // The last byte is rechecked too, in case a block straddling two pages has since had one paged out.
+  if (block.physical_start == physical_start && block.entries[0].pc == address &&
+      memory_.physical_address(last_address) == block.physical_end - 1 && valid(block))
+    return &block;
+
+  block = Block{physical_start, physical_start, memory_.write_stamp()};
+  for (std::size_t pc = address; block.length < Block::MaxLength;) {
+    const auto step = impl::decode_block_step(memory_, static_cast<std::uint16_t>(pc));
+    const auto last_byte = pc + step.length - 1;
+    // Stop at anything uncacheable, and at the edge of a page, so the block is one physically contiguous range.
+    if (!step.length || last_byte > 0xffff ||
+        memory_.physical_address(static_cast<std::uint16_t>(last_byte)) != physical_start + (last_byte - address))
+      break;
+    block.entries[block.length++] = {step.execute, static_cast<std::uint16_t>(pc), step.fetches};
+    pc += step.length;
+    block.physical_end = physical_start + (pc - address);
+    if (step.ends_block)
+      break;
+  }
+  if (!block.length) {
+    block.physical_start = ~0uz;
+    return nullptr;
+  }
+  return &block;
+}
+
+bool Z80::valid(const Block &block) const {
+  for (auto physical = block.physical_start; physical < block.physical_end; physical += Memory::WriteBlockSize) {
+    if (memory_.block_write_stamp(physical) > block.stamp)
+      return false;
+  }
+  return memory_.block_write_stamp(block.physical_end - 1) <= block.stamp;
+}
+
 void Z80::branch(const std::int8_t offset) { regs_.pc(static_cast<std::uint16_t>(regs_.pc() + offset)); }
 
 std::uint8_t Z80::read_opcode() {
   const auto opcode = read_immediate();
+  refresh();
+  return opcode;
+}
+
+void Z80::refresh() {
   // One cycle refresh.
   regs_.r((regs_.r() & 0x80) | ((regs_.r() + 1) & 0x7f));
   pass_time(1);
-  return opcode;
 }
 
 
 std::uint8_t Z80::read_immediate() {
-  pass_time(3);
   const auto addr = regs_.pc();
+  contend(addr);
+  pass_time(3);
   regs_.pc(addr + 1);
   return memory_.read(addr);
 }
@@ -46,11 +124,13 @@ std::uint16_t Z80::read_immediate16() {
 }
 
 void Z80::write(const std::uint16_t address, const std::uint8_t byte) {
+  contend(address);
   pass_time(3);
   memory_.write(address, byte);
 }
 
 std::uint8_t Z80::read(const std::uint16_t address) {
+  contend(address);
   pass_time(3);
   return memory_.read(address);
 }
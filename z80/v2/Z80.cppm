@@ -1,9 +1,11 @@
 module;
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <optional>
+#include <span>
 #include <vector>
 
 export module z80_v2:Z80;
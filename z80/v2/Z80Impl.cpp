@@ -43,6 +43,39 @@ void decode_and_run_fdcb(Z80 &z80) {
   fdcb_table<build_execute>[opcode](z80);
 }
 
+namespace {
+
+BlockStep step_from(const BlockInfo info, const execute_ptr_t execute, const std::uint8_t fetches) {
+  return {execute, fetches, static_cast<std::uint8_t>(fetches + info.operand_bytes), info.ends_block};
+}
+
+BlockStep index_step(const std::uint8_t opcode, const auto &execute_table, const auto &info_table) {
+  switch (opcode) {
+    // The DDCB/FDCB handler reads its offset and final opcode itself, so only the two prefixes are consumed up front.
+    case 0xcb: return {execute_table[opcode], 2, 4, false};
+    case 0xdd:
+    case 0xed:
+    case 0xfd: return {};
+    default: return step_from(info_table[opcode], execute_table[opcode], 2);
+  }
+}
+
+} // namespace
+
+BlockStep decode_block_step(const Memory &memory, const std::uint16_t address) {
+  const auto opcode = memory.read(address);
+  const auto next = memory.read(static_cast<std::uint16_t>(address + 1));
+  switch (opcode) {
+    case 0xcb: return step_from(cb_table<build_block_info>[next], cb_table<build_execute_hl>[next], 2);
+    case 0xed: return step_from(ed_table<build_block_info>[next], ed_table<build_execute>[next], 2);
+    case 0xdd:
+      return index_step(next, dd_table<build_execute_ixiy<RegisterFile::R16::IX>>, dd_table<build_block_info>);
+    case 0xfd:
+      return index_step(next, fd_table<build_execute_ixiy<RegisterFile::R16::IY>>, fd_table<build_block_info>);
+    default: return step_from(table<build_block_info>[opcode], table<build_execute_hl>[opcode], 1);
+  }
+}
+
 // TODO the fdcb and ddcb tables miss out on the duplicated encodings and the `res 0,(ix+d,b)` type instructions.
 //   Hopefully won't matter for now...
 
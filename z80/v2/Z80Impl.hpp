@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <format>
 #include <string>
+#include <string_view>
 #include <utility>
 #endif
 
@@ -919,6 +920,8 @@ template<bool increment, bool repeat>
 struct BlockLoadOp {
   static constexpr Mnemonic mnemonic{"ld"s + (increment ? "i" : "d") + (repeat ? "r" : "")};
   static constexpr void execute(Z80 &z80) {
+    if constexpr (repeat)
+      z80.bulk_block_load(increment);
     constexpr std::uint16_t add = increment ? 0x0001 : 0xffff;
     const auto hl = z80.regs().get(RegisterFile::R16::HL);
     z80.regs().set(RegisterFile::R16::HL, hl + add);
@@ -954,6 +957,8 @@ template<bool increment, bool repeat>
 struct BlockCompareOp {
   static constexpr Mnemonic mnemonic{"cp"s + (increment ? "i" : "d") + (repeat ? "r" : "")};
   static constexpr void execute(Z80 &z80) {
+    if constexpr (repeat)
+      z80.bulk_block_compare(increment);
     constexpr std::uint16_t add = increment ? 0x0001 : 0xffff;
     const auto hl = z80.regs().get(RegisterFile::R16::HL);
     z80.regs().set(RegisterFile::R16::HL, hl + add);
@@ -1078,6 +1083,32 @@ struct build_execute_hl {
   }
 };
 
+// What the block cache needs to know about each instruction: how many bytes follow the opcode, and whether it can
+// transfer control (or change paging), so a straight-line block must stop after it.
+SPECBOLT_EXPORT struct BlockInfo {
+  std::uint8_t operand_bytes{};
+  bool ends_block{};
+};
+
+SPECBOLT_EXPORT constexpr BlockInfo block_info_for(const std::string_view mnemonic) {
+  BlockInfo info{};
+  for (auto pos = mnemonic.find('$'); pos != std::string_view::npos; pos = mnemonic.find('$', pos + 1)) {
+    const auto bytes = mnemonic.substr(pos + 1).starts_with("nnnn") ? 2 : 1;
+    info.operand_bytes = static_cast<std::uint8_t>(info.operand_bytes + bytes);
+  }
+  for (const auto prefix: {"jp"sv, "jr"sv, "call"sv, "ret"sv, "rst"sv, "djnz"sv, "halt"sv, "out"sv, "ot"sv}) {
+    if (mnemonic.starts_with(prefix))
+      info.ends_block = true;
+  }
+  return info;
+}
+
+struct build_block_info {
+  template<auto op>
+    requires OpLike<decltype(op)>
+  static constexpr auto result = block_info_for(decltype(op)::mnemonic.view());
+};
+
 SPECBOLT_EXPORT template<typename Builder>
 constexpr auto table = generic_table<select_base_instruction, Builder, HlSet::Base>;
 SPECBOLT_EXPORT template<typename Builder>
@@ -1093,5 +1124,16 @@ constexpr auto fdcb_table = generic_table<select_cb_instruction, Builder, HlSet:
 SPECBOLT_EXPORT template<typename Builder>
 constexpr auto ed_table = generic_table<select_ed_instruction, Builder, HlSet::Base>;
 
+// One fully-decoded instruction for the block cache: the handler to call once `fetches` opcode bytes (prefixes
+// included) have been consumed. A zero length means the instruction can't be cached (e.g. runs of index prefixes).
+struct BlockStep {
+  execute_ptr_t execute{};
+  std::uint8_t fetches{};
+  std::uint8_t length{};
+  bool ends_block{};
+};
+
+[[nodiscard]] BlockStep decode_block_step(const Memory &memory, std::uint16_t address);
+
 
 } // namespace specbolt::v2::impl
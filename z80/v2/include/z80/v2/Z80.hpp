@@ -5,8 +5,10 @@
 #include "z80/common/RegisterFile.hpp"
 #include "z80/common/Z80Base.hpp"
 
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "peripherals/Memory.hpp"
 #endif
@@ -17,7 +19,12 @@ SPECBOLT_EXPORT class Z80 : public Z80Base {
 public:
   explicit Z80(Scheduler &scheduler, Memory &memory) : Z80Base(scheduler, memory) {}
 
+  static constexpr bool ContendsAccesses = true;
+
   void execute_one();
+  // Runs the rest of the straight-line block at PC, stopping early at `until_cycle`, on an interrupt, or if the block's
+  // code is overwritten. Falls back to a single instruction when there's nothing cacheable to run.
+  void execute_block(std::size_t until_cycle);
 
   void branch(std::int8_t offset);
 
@@ -34,6 +41,28 @@ public:
 
 private:
   void handle_interrupt();
+  void refresh();
+
+  // Direct-mapped cache of pre-decoded basic blocks, indexed by PC. Each block's bytes are physically contiguous and are
+  // validated against Memory's write stamps, so self-modifying code and paging are both handled.
+  struct Block {
+    struct Entry {
+      void (*execute)(Z80 &){};
+      std::uint16_t pc{};
+      std::uint8_t fetches{};
+    };
+    static constexpr auto MaxLength = 16uz;
+    std::size_t physical_start{~0uz};
+    std::size_t physical_end{};
+    std::uint64_t stamp{};
+    std::size_t length{};
+    std::array<Entry, MaxLength> entries{};
+  };
+  [[nodiscard]] const Block *block_at(std::uint16_t address);
+  [[nodiscard]] bool valid(const Block &block) const;
+
+  static constexpr auto BlockCacheSize = 1024uz;
+  std::vector<Block> block_cache_ = std::vector<Block>(BlockCacheSize);
 };
 
 } // namespace specbolt::v2
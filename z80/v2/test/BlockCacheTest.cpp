@@ -0,0 +1,118 @@
+#ifdef SPECBOLT_MODULES
+import peripherals;
+import z80_common;
+import z80_v2;
+#else
+#include "peripherals/Memory.hpp"
+#include "z80/common/Scheduler.hpp"
+#include "z80/v2/Z80.hpp"
+#include "z80/v2/Z80Impl.hpp"
+#endif
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+namespace specbolt::v2 {
+
+static_assert(impl::block_info_for("ld a, $nn").operand_bytes == 1);
+static_assert(impl::block_info_for("ld ($nnnn), a").operand_bytes == 2);
+static_assert(impl::block_info_for("ld (ix$o), $nn").operand_bytes == 2);
+static_assert(!impl::block_info_for("ld (ix$o), $nn").ends_block);
+static_assert(impl::block_info_for("jr nz, $d").ends_block);
+static_assert(impl::block_info_for("ret").ends_block);
+static_assert(impl::block_info_for("out (c), a").ends_block);
+
+namespace {
+
+struct Machine {
+  Scheduler scheduler;
+  Memory memory{4};
+  Z80 z80{scheduler, memory};
+
+  Machine() { memory.set_rom_flags({false, false, false, false}); }
+
+  void run_stepping(const std::size_t until_cycle) {
+    while (z80.cycle_count() < until_cycle)
+      z80.execute_one();
+  }
+  void run_blocks(const std::size_t until_cycle) {
+    while (z80.cycle_count() < until_cycle)
+      z80.execute_block(until_cycle);
+  }
+};
+
+void check_same(const Machine &lhs, const Machine &rhs) {
+  CHECK(lhs.z80.cycle_count() == rhs.z80.cycle_count());
+  CHECK(lhs.z80.pc() == rhs.z80.pc());
+  CHECK(lhs.z80.regs().r() == rhs.z80.regs().r());
+  for (const auto r16: {RegisterFile::R16::AF, RegisterFile::R16::BC, RegisterFile::R16::DE, RegisterFile::R16::HL,
+           RegisterFile::R16::IX, RegisterFile::R16::IY}) {
+    CHECK(lhs.z80.regs().get(r16) == rhs.z80.regs().get(r16));
+  }
+  for (std::uint16_t address = 0x8000; address < 0x8020; ++address)
+    CHECK(lhs.memory.read(address) == rhs.memory.read(address));
+}
+
+} // namespace
+
+TEST_CASE("Block execution matches single stepping") {
+  Machine stepped;
+  Machine blocked;
+  for (auto *machine: {&stepped, &blocked}) {
+    write_to_memory(machine->memory, 0,
+        // clang-format off
+        0x3e, 0x12,             // ld a, 0x12
+        0x21, 0x00, 0x80,       // ld hl, 0x8000
+        0x77,                   // ld (hl), a
+        0x23,                   // inc hl
+        0xdd, 0x21, 0x10, 0x80, // ld ix, 0x8010
+        0xdd, 0x77, 0x01,       // ld (ix+1), a
+        0xdd, 0xcb, 0x01, 0xce, // set 1, (ix+1)
+        0xcb, 0x00,             // rlc b
+        0xed, 0x44,             // neg
+        0x10, 0xf2,             // djnz -14 (back to ld (ix+1), a)
+        0x18, 0xfe              // jr $
+        // clang-format on
+    );
+  }
+  SECTION("to completion") {
+    stepped.run_stepping(2000);
+    blocked.run_blocks(2000);
+    check_same(stepped, blocked);
+  }
+  SECTION("stopping part way through a block") {
+    for (auto until = 4uz; until < 200; until += 7) {
+      stepped.run_stepping(until);
+      blocked.run_blocks(until);
+      check_same(stepped, blocked);
+    }
+  }
+}
+
+TEST_CASE("Block execution sees self-modifying code") {
+  Machine machine;
+  write_to_memory(machine.memory, 0,
+      // clang-format off
+      0x3e, 0x3c,       // ld a, 0x3c (inc a)
+      0x32, 0x07, 0x00, // ld (0x0007), a
+      0x00,             // nop
+      0x00,             // nop
+      0x00,             // nop, about to become inc a
+      0x76              // halt
+      // clang-format on
+  );
+  SECTION("written by the block itself") {
+    machine.run_blocks(100);
+    CHECK(machine.z80.halted());
+    CHECK(machine.z80.regs().get(RegisterFile::R8::A) == 0x3d);
+  }
+  SECTION("written after the block was cached") {
+    machine.run_blocks(7); // Just the ld a, 0x3c, but the whole block is now cached.
+    machine.memory.write(5, 0x3c);
+    machine.run_blocks(100);
+    CHECK(machine.z80.halted());
+    CHECK(machine.z80.regs().get(RegisterFile::R8::A) == 0x3e);
+  }
+}
+
+} // namespace specbolt::v2
@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <iostream>
 #include <print>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace std::literals;
@@ -61,6 +64,14 @@ struct AluOp {
   std::string op;
 };
 
+// Set by --lazy-flags: 8-bit arithmetic and logic record their operands in lazy_flags_ instead of computing F.
+bool lazy_flags{};
+
+std::string deferred(const std::string_view op, const std::string_view lhs, const std::string_view rhs,
+    const std::string_view carry_in = "false") {
+  return std::format("lazy_flags_.defer<LazyFlags::Op::{}>({}, {}, {})", op, lhs, rhs, carry_in);
+}
+
 constexpr std::array cc_names = {"nz", "z", "nc", "c", "po", "pe", "p", "m"};
 
 // http://www.z80.info/decoding.htm
@@ -184,6 +195,19 @@ Op match_op(const Opcode opcode) {
 
   if (opcode.x == 0 && (opcode.z == 4 || opcode.z == 5)) {
     const auto operation = opcode.z == 4 ? "inc" : "dec";
+    if (lazy_flags) {
+      const auto lazy_op = opcode.z == 4 ? "Inc8" : "Dec8";
+      if (opcode.y == 6) {
+        return {std::format("{} {}", operation, opcode.reg_set.r[opcode.y]),
+            {"const auto address = regs_.wz();", "const auto rhs = read(address);", "pass_time(1);",
+                std::format("write(address, {});", deferred(lazy_op, "rhs", "0", "check_c()"))},
+            true};
+      }
+      return {std::format("{} {}", operation, opcode.reg_set.r[opcode.y]),
+          {std::format("const auto rhs = get(R8::{});", upper(opcode.reg_set.r[opcode.y])),
+              std::format("set(R8::{}, {});", upper(opcode.reg_set.r[opcode.y]),
+                  deferred(lazy_op, "rhs", "0", "check_c()"))}};
+    }
     if (opcode.y == 6) {
       return {std::format("{} {}", operation, opcode.reg_set.r[opcode.y]),
           {std::format("const auto address = regs_.wz();"), std::format("const auto rhs = read(address);"),
@@ -260,6 +284,24 @@ Op match_op(const Opcode opcode) {
                      : is_immediate ? "read_immediate()"
                                     : std::format("get(R8::{})", upper(opcode.reg_set.r[opcode.alu_input_selector()]));
     const auto [name, op] = alu_ops[opcode.y];
+    if (lazy_flags) {
+      const std::array lazy_alu_ops = {
+          deferred("Add8", "get(R8::A)", "rhs"),
+          deferred("Add8", "get(R8::A)", "rhs", "check_c()"),
+          deferred("Sub8", "get(R8::A)", "rhs"),
+          deferred("Sub8", "get(R8::A)", "rhs", "check_c()"),
+          deferred("And8", "get(R8::A)", "rhs"),
+          deferred("Xor8", "get(R8::A)", "rhs"),
+          deferred("Or8", "get(R8::A)", "rhs"),
+          deferred("Cmp8", "get(R8::A)", "rhs"),
+      };
+      return {std::format("{} {}", name, opcode.reg_set.r[opcode.alu_input_selector()]),
+          {
+              std::format("const auto rhs = {};", rhs),
+              std::format("set(R8::A, {});", lazy_alu_ops[opcode.y]),
+          },
+          is_indirect, is_immediate};
+    }
     return {std::format("{} {}", name, opcode.reg_set.r[opcode.alu_input_selector()]),
         {
             std::format("const auto rhs = {};", rhs),
@@ -389,6 +431,8 @@ Op match_op_ed(const Opcode opcode) {
             std::format("set(R8::{}, read(addr + 1));", upper(opcode.reg_set.rp_high[opcode.p])),
         }};
 
+  if (opcode.x == 1 && opcode.z == 4 && lazy_flags)
+    return {"neg", {std::format("set(R8::A, {});", deferred("Sub8", "0", "get(R8::A)"))}};
   if (opcode.x == 1 && opcode.z == 4)
     return {"neg", {"const auto [result, new_flags] = Alu::sub8(0, get(R8::A), false);", "set(R8::A, result);",
                        "flags(new_flags);"}};
@@ -456,6 +500,7 @@ Op match_op_ed(const Opcode opcode) {
         "flags(preserved_flags | flags_from_bits | flags_from_bc);",
     };
     if (repeat) {
+      ops.insert(ops.begin(), std::format("bulk_block_load({});", increment));
       ops.emplace_back("if (new_bc) {");
       ops.emplace_back("  regs_.wz(regs_.pc() - 1);");
       ops.emplace_back("  regs_.pc(regs_.pc() - 2);");
@@ -491,6 +536,7 @@ Op match_op_ed(const Opcode opcode) {
         "flags(preserved_flags | flags_from_bits | flags_from_bc | (from_subtract_mask & subtract_flags));",
     };
     if (repeat) {
+      ops.insert(ops.begin(), std::format("bulk_block_compare({});", increment));
       ops.emplace_back("if (new_bc && !subtract_flags.zero()) {");
       ops.emplace_back("  regs_.wz(regs_.pc() - 1);");
       ops.emplace_back("  regs_.pc(regs_.pc() - 2);");
@@ -571,6 +617,10 @@ void Z80::{}() {{
     const auto op = match_func(opcode);
     std::print(out, "    case 0x{:02x}: {{ // {}\n", opcode_num, op.name);
 
+    // AF is read and written as a whole, so F must be up to date first.
+    if (lazy_flags && std::ranges::any_of(op.code, [](const auto &line) { return line.contains("R16::AF"); }))
+      std::print(out, "      materialise_flags();\n");
+
     if (op.indirect && !always_indirect) {
       if (set.index_reg == "hl"s)
         std::print(out, "      regs_.wz(get(R16::HL));\n");
@@ -592,6 +642,56 @@ void Z80::{}() {{
   std::print(out, "  }}\n}}\n");
 }
 
+void output_flag_accessors(std::ostream &out) {
+  if (lazy_flags) {
+    std::print(out, R"(
+Flags Z80::flags() const {{ return lazy_flags_.pending() ? lazy_flags_.evaluate() : Z80Base::flags(); }}
+void Z80::flags(const Flags flags) {{
+  lazy_flags_.clear();
+  Z80Base::flags(flags);
+}}
+RegisterFile Z80::regs() const {{
+  auto regs = regs_;
+  regs.set(R8::F, flags().to_u8());
+  return regs;
+}}
+RegisterFile &Z80::regs() {{
+  materialise_flags();
+  return regs_;
+}}
+void Z80::materialise_flags() {{
+  if (lazy_flags_.pending())
+    flags(lazy_flags_.evaluate());
+}}
+)");
+  }
+  else {
+    std::print(out, R"(
+Flags Z80::flags() const {{ return Z80Base::flags(); }}
+void Z80::flags(const Flags flags) {{ Z80Base::flags(flags); }}
+RegisterFile Z80::regs() const {{ return regs_; }}
+RegisterFile &Z80::regs() {{ return regs_; }}
+void Z80::materialise_flags() {{}}
+)");
+  }
+  // The conditions each need only one flag, which the lazy flags can answer without building all of F.
+  constexpr std::array<std::pair<std::string_view, std::string_view>, 4> conditions{{
+      {"z", "zero"},
+      {"c", "carry"},
+      {"pe", "parity"},
+      {"m", "sign"},
+  }};
+  constexpr std::array<std::string_view, 4> inverse_names{"nz", "nc", "po", "p"};
+  for (auto index = 0uz; index < conditions.size(); ++index) {
+    const auto &[name, flag] = conditions[index];
+    const auto test = lazy_flags
+                          ? std::format("lazy_flags_.pending() ? lazy_flags_.{0}() : Z80Base::flags().{0}()", flag)
+                          : std::format("Z80Base::flags().{}()", flag);
+    std::print(out, "bool Z80::check_{}() const {{ return {}; }}\n", name, test);
+    std::print(out, "bool Z80::check_{}() const {{ return !({}); }}\n", inverse_names[index], test);
+  }
+}
+
 template<typename Func>
 void output_disasm(std::ostream &out, const std::string &name, const RegisterSet &set, Func &&match_func) {
   std::print(out, R"(
@@ -611,18 +711,21 @@ std::string_view impl::{}(std::uint8_t opcode) {{
 } // namespace
 
 int main(int argc, const char *argv[]) {
+  std::vector<std::string_view> args(argv + 1, argv + argc);
+  lazy_flags = std::erase(args, "--lazy-flags") > 0;
   std::ofstream maybe_out;
   std::string path_prefix{"."};
-  if (argc > 1)
-    maybe_out.open(argv[1]);
-  if (argc > 2)
-    path_prefix = argv[2];
-  std::ostream &out = argc > 1 ? maybe_out : std::cout;
+  if (!args.empty())
+    maybe_out.open(std::string(args[0]));
+  if (args.size() > 1)
+    path_prefix = args[1];
+  std::ostream &out = !args.empty() ? maybe_out : std::cout;
   std::print(out, R"(// Automatically generated, DO NOT EDIT
 
 #ifndef SPECBOLT_MODULES
 #include "{}/DisassembleInternal.hpp"
 #include "z80/common/Alu.hpp"
+#include "z80/common/LazyFlags.hpp"
 #include "z80/common/RegisterFile.hpp"
 #include "z80/v3/Z80.hpp"
 #endif
@@ -634,6 +737,8 @@ using R8 = RegisterFile::R8;
 )",
       path_prefix);
 
+  output_flag_accessors(out);
+
   output_func(out, "execute_one_base", base_set, false, match_op);
   output_func(out, "execute_one_ed", base_set, false, match_op_ed);
   output_func(out, "execute_one_cb", base_set, false, match_op_cb);
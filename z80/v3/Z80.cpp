@@ -12,7 +12,7 @@ void Z80::execute_one() {
     handle_interrupt();
   }
   if (halted_) [[unlikely]] {
-    pass_time(1);
+    pass_halted_time();
     return;
   }
 
@@ -31,8 +31,9 @@ std::uint8_t Z80::read_opcode() {
 
 
 std::uint8_t Z80::read_immediate() {
-  pass_time(3);
   const auto addr = regs_.pc();
+  contend(addr);
+  pass_time(3);
   regs_.pc(addr + 1);
   return memory_.read(addr);
 }
@@ -44,11 +45,13 @@ std::uint16_t Z80::read_immediate16() {
 }
 
 void Z80::write(const std::uint16_t address, const std::uint8_t byte) {
+  contend(address);
   pass_time(3);
   memory_.write(address, byte);
 }
 
 std::uint8_t Z80::read(const std::uint16_t address) {
+  contend(address);
   pass_time(3);
   return memory_.read(address);
 }
@@ -101,13 +104,4 @@ void Z80::handle_interrupt() {
   }
 }
 
-bool Z80::check_nz() const { return !flags().zero(); }
-bool Z80::check_z() const { return flags().zero(); }
-bool Z80::check_nc() const { return !flags().carry(); }
-bool Z80::check_c() const { return flags().carry(); }
-bool Z80::check_po() const { return !flags().parity(); }
-bool Z80::check_pe() const { return flags().parity(); }
-bool Z80::check_p() const { return !flags().sign(); }
-bool Z80::check_m() const { return flags().sign(); }
-
 } // namespace specbolt::v3
@@ -2,6 +2,7 @@
 
 #ifndef SPECBOLT_MODULES
 #include "z80/common/Flags.hpp"
+#include "z80/common/LazyFlags.hpp"
 #include "z80/common/RegisterFile.hpp"
 #include "z80/common/Z80Base.hpp"
 
@@ -17,8 +18,26 @@ SPECBOLT_EXPORT class Z80 : public Z80Base {
 public:
   explicit Z80(Scheduler &scheduler, Memory &memory) : Z80Base(scheduler, memory) {}
 
+  static constexpr bool ContendsAccesses = true;
+
   void execute_one();
 
+  // When generated with --lazy-flags, F may be out of date until something reads it. These hide the Z80Base versions
+  // so every read sees the right flags; the mutable regs() brings F up to date before handing out the reference.
+  [[nodiscard]] Flags flags() const;
+  void flags(Flags flags);
+  [[nodiscard]] RegisterFile regs() const;
+  [[nodiscard]] RegisterFile &regs();
+  [[nodiscard]] Checkpoint checkpoint() const {
+    auto checkpoint = Z80Base::checkpoint();
+    checkpoint.regs = regs();
+    return checkpoint;
+  }
+  void restore(const Checkpoint &checkpoint) {
+    lazy_flags_.clear();
+    Z80Base::restore(checkpoint);
+  }
+
   void branch(std::int8_t offset);
 
   std::uint8_t read_opcode();
@@ -34,6 +53,9 @@ public:
 
 private:
   void handle_interrupt();
+  void materialise_flags();
+
+  LazyFlags lazy_flags_;
 
   [[nodiscard]] bool check_nz() const;
   [[nodiscard]] bool check_z() const;
@@ -44,7 +66,7 @@ private:
   [[nodiscard]] bool check_p() const;
   [[nodiscard]] bool check_m() const;
 
-  // Implementation is in the generated code
+  // Implementation is in the generated code, along with the flag accessors and checks above.
   void execute_one_base();
   void execute_one_cb();
   void execute_one_ed();